@@ -0,0 +1,314 @@
+#include "game.h"
+#include <SDL2/SDL_timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+const float BENCH_DELTA = 1.0f / 60.0f;
+const Uint32 BENCH_SEED = 1;
+
+const int STRESS_ASTEROIDS = 10000;
+const int STRESS_PROJECTILES = 100000;
+const int FRAGMENT_ASTEROIDS = 1000; // large asteroids split every tick
+const int ALIEN_VOLLEY = 50;         // alien shots fired every tick
+const int ALIEN_SWARM = 500;         // aliens steering and firing at once
+// One burst that outlives the default run, like the projectile stress
+const Emitter PARTICLE_STRESS = {100000, 20.0f, 80.0f, 0, 0, 10.0f};
+
+/*-----------------------------------STRUCTS----------------------------------*/
+
+typedef struct {
+    const char* name;
+    Uint64 ticks;
+    Uint8 input;
+    void (*setup)(State* state);
+    void (*step)(State* state, Uint32 time); // before each tick, may be NULL
+} Scenario;
+
+typedef struct {
+    Uint64 ticks;
+    double ns;
+    double entities;   // summed over ticks, divide by ticks for the mean
+    Uint64 allocs;     // malloc, calloc and realloc calls while ticking
+    Uint64 pairTests;
+    int score;
+    int level;
+    int asteroids;
+    int projectiles;
+} BenchResult;
+
+/*---------------------------------ALLOCATIONS--------------------------------*/
+
+#ifdef BENCH_COUNT_ALLOCS
+
+// The linker sends every allocation in the game code here, see
+// CMakeLists.txt. Calls made inside SDL itself are not counted.
+Uint64 allocCount = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t num, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    allocCount++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t num, size_t size) {
+    allocCount++;
+    return __real_calloc(num, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    allocCount++;
+    return __real_realloc(ptr, size);
+}
+
+static Uint64 alloc_count(void) { return allocCount; }
+
+#else
+
+static Uint64 alloc_count(void) { return 0; }
+
+#endif
+
+/*----------------------------------SCENARIOS---------------------------------*/
+
+static void setup_asteroids(State* state) {
+    spawn_asteroids(state, STRESS_ASTEROIDS);
+}
+
+// Shots spread over the screen in every direction, fired at tick zero so
+// none expire within the default run
+static void setup_projectiles(State* state) {
+    spawn_asteroids(state, INIT_NUM_ASTEROIDS);
+    reserve_projectiles(&state->projectiles, STRESS_PROJECTILES);
+    for (int i = 0; i < STRESS_PROJECTILES; i++) {
+        float x = rng_float(&state->rng, 0, SCREEN_WIDTH);
+        float y = rng_float(&state->rng, 0, SCREEN_HEIGHT);
+        float angle = rng_float(&state->rng, 0, (2.0f * M_PI));
+        fire_projectile(&state->projectiles, create_vector(x, y), angle, 0);
+    }
+}
+
+static void setup_fragments(State* state) {
+    spawn_asteroids(state, FRAGMENT_ASTEROIDS);
+}
+
+// Every asteroid is split through on_destroy() each tick: large into
+// medium, medium into small, and small ones vanish before a top up. The
+// fragments are added straight away rather than SPAWN_BUDGET a tick.
+static void step_fragments(State* state, Uint32 time) {
+    (void)time;
+    AsteroidArray* asteroids = &state->asteroids;
+    if (asteroids->count == 0 && state->spawns.count == 0) {
+        spawn_asteroids(state, FRAGMENT_ASTEROIDS);
+    }
+
+    int count = asteroids->count;
+    for (int i = 0; i < count; i++) {
+        Vector2 position = create_vector(asteroids->x[i], asteroids->y[i]);
+        on_destroy(state, asteroids->size[i], position);
+    }
+    drain_spawns(state, state->spawns.count);
+    // Backwards, so each swap brings in a fragment rather than a parent
+    for (int i = count - 1; i >= 0; i--) {
+        remove_asteroid(asteroids, i);
+    }
+}
+
+static void setup_alien(State* state) {
+    spawn_asteroids(state, INIT_NUM_ASTEROIDS);
+    state->level = 2;
+    spawn_aliens(state, aliens_for_level(state->level), 0);
+}
+
+// A fan of alien shots every tick on top of its normal fire
+static void step_alien(State* state, Uint32 time) {
+    AlienArray* aliens = &state->aliens;
+    if (aliens->count == 0) {
+        return;
+    }
+    Vector2 position = create_vector(aliens->x[0], aliens->y[0]);
+    for (int i = 0; i < ALIEN_VOLLEY; i++) {
+        float angle = aliens->rotation[0] + (i - ALIEN_VOLLEY / 2) * 0.02f;
+        fire_projectile(&state->alienProjs, position, angle, time);
+    }
+}
+
+static void setup_swarm(State* state) {
+    spawn_asteroids(state, INIT_NUM_ASTEROIDS);
+    state->level = 2;
+    spawn_aliens(state, ALIEN_SWARM, 0);
+}
+
+static void setup_particles(State* state) {
+    spawn_asteroids(state, INIT_NUM_ASTEROIDS);
+    Vector2 centre = create_vector(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f);
+    emit_particles(&state->particles, &PARTICLE_STRESS, centre,
+                   create_vector(0, 0), &state->fxRng);
+}
+
+const Scenario SCENARIOS[] = {
+    {"asteroids_10k", 600, 0, setup_asteroids, NULL},
+    {"projectiles_100k", 300, INPUT_LEFT, setup_projectiles, NULL},
+    {"fragmentation", 600, INPUT_LEFT, setup_fragments, step_fragments},
+    {"alien_fire", 1200, 0, setup_alien, step_alien},
+    {"alien_swarm", 1200, INPUT_SHOOT, setup_swarm, NULL},
+    {"particles_100k", 300, 0, setup_particles, NULL},
+};
+
+const int NUM_SCENARIOS = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+static int entity_count(const State* state) {
+    return state->aliens.count + state->asteroids.count +
+           state->projectiles.count + state->alienProjs.count +
+           state->particles.count;
+}
+
+// Setup is not timed, each tick and the scenario step before it are
+static int run_scenario(const Scenario* scenario, Uint64 ticks, Uint32 seed,
+                        JobSystem* jobs, BenchResult* result) {
+    State* state = init_state();
+    if (!state) {
+        fprintf(stderr, "Failed to initialize game state!\n");
+        return GAME_ERROR;
+    }
+    state->jobs = jobs;
+    seed_state(state, seed);
+    scenario->setup(state);
+
+    Time gameTime = {0};
+    gameTime.deltaTime = BENCH_DELTA;
+
+    double entities = 0;
+    Uint64 allocs = alloc_count();
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (Uint64 tick = 1; tick <= ticks; tick++) {
+        gameTime.time = tick_time(tick, BENCH_DELTA);
+        gameTime.frames++;
+        if (scenario->step) {
+            scenario->step(state, gameTime.time);
+        }
+        update_state(state, scenario->input, &gameTime);
+        entities += entity_count(state);
+    }
+    Uint64 end = SDL_GetPerformanceCounter();
+
+    result->ticks = ticks;
+    result->ns = (double)(end - start) * 1e9 / SDL_GetPerformanceFrequency();
+    result->entities = entities;
+    result->allocs = alloc_count() - allocs;
+    result->pairTests = state->pairTests;
+    result->score = state->score;
+    result->level = state->level;
+    result->asteroids = state->asteroids.count;
+    result->projectiles = state->projectiles.count + state->alienProjs.count;
+
+    free_state(state);
+    return OK;
+}
+
+// One CSV row per scenario. The columns after the timings depend only on
+// the seed, so a diff between commits shows behaviour changes as well.
+static void print_result(FILE* out, const Scenario* scenario, Uint32 seed,
+                         int workers, const BenchResult* result) {
+    double nsPerTick = result->ns / result->ticks;
+    double meanEntities = result->entities / result->ticks;
+    fprintf(out, "%s,%s,%d,%u,%llu,%.0f,%.2f,%.2f,%llu,%d,%d,%d,%d\n",
+            scenario->name, integrate_backend_name(integrate_backend()),
+            workers, seed, (unsigned long long)result->ticks,
+            nsPerTick, meanEntities > 0 ? nsPerTick / meanEntities : 0.0,
+            (double)result->allocs / result->ticks,
+            (unsigned long long)result->pairTests, result->score,
+            result->level, result->asteroids, result->projectiles);
+}
+
+static int parse_backend(const char* name) {
+    for (int i = 0; i < NUM_INTEGRATE_BACKENDS; i++) {
+        if (strcmp(name, integrate_backend_name((IntegrateBackend)i)) == 0) {
+            return set_integrate_backend((IntegrateBackend)i);
+        }
+    }
+    return 0;
+}
+
+static void print_usage(FILE* out, const char* program) {
+    fprintf(out,
+            "Usage: %s [--scenario NAME] [--ticks N] [--seed N] "
+            "[--backend scalar|sse2|avx2] [--workers N]\n",
+            program);
+    fprintf(out, "Scenarios:");
+    for (int i = 0; i < NUM_SCENARIOS; i++) {
+        fprintf(out, " %s", SCENARIOS[i].name);
+    }
+    fprintf(out, "\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* only = NULL;
+    Uint64 ticks = 0; // 0 keeps each scenario's own length
+    Uint32 seed = BENCH_SEED;
+    int workers = default_workers();
+    init_integrate();
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        int hasValue = i + 1 < argc;
+        if (strcmp(arg, "--scenario") == 0 && hasValue) {
+            only = argv[++i];
+        } else if (strcmp(arg, "--ticks") == 0 && hasValue) {
+            ticks = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--seed") == 0 && hasValue) {
+            seed = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--workers") == 0 && hasValue) {
+            workers = atoi(argv[++i]);
+        } else if (strcmp(arg, "--backend") == 0 && hasValue) {
+            const char* name = argv[++i];
+            if (!parse_backend(name)) {
+                fprintf(stderr, "Backend %s is not available!\n", name);
+                return GAME_ERROR;
+            }
+        } else {
+            print_usage(stderr, argv[0]);
+            return GAME_ERROR;
+        }
+    }
+
+    JobSystem* jobs = init_jobs(workers);
+    if (!jobs) {
+        return GAME_ERROR;
+    }
+
+    int ran = 0;
+    printf("scenario,backend,workers,seed,ticks,ns_per_tick,ns_per_entity,"
+           "allocs_per_tick,pair_tests,score,level,asteroids,projectiles\n");
+    for (int i = 0; i < NUM_SCENARIOS; i++) {
+        const Scenario* scenario = &SCENARIOS[i];
+        if (only && strcmp(only, scenario->name) != 0) {
+            continue;
+        }
+
+        BenchResult result;
+        Uint64 length = ticks ? ticks : scenario->ticks;
+        if (run_scenario(scenario, length, seed, jobs, &result) != OK) {
+            free_jobs(jobs);
+            return GAME_ERROR;
+        }
+        print_result(stdout, scenario, seed, jobs->numWorkers, &result);
+        fflush(stdout);
+        ran++;
+    }
+
+    free_jobs(jobs);
+    if (ran == 0) {
+        fprintf(stderr, "Unknown scenario %s!\n", only);
+        print_usage(stderr, argv[0]);
+        return GAME_ERROR;
+    }
+    return OK;
+}
@@ -0,0 +1,25 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <SDL2/SDL_audio.h>
+
+// Every sound in the pack is raw PCM already in the format the mixer is
+// opened with, so loading one is a pointer and a length
+#define ASSET_FREQUENCY 44100
+#define ASSET_FORMAT AUDIO_S16SYS
+#define ASSET_CHANNELS 2
+#define ASSET_ALIGN 16 // bytes, each sound starts on a multiple of this
+
+// Where one sound lies in ASSET_DATA, in bytes
+typedef struct {
+    Uint32 offset;
+    Uint32 length;
+} AssetEntry;
+
+// Defined in the assets.c that tools/pack_assets.c writes at build time,
+// with the sounds in SoundId order
+extern const int NUM_ASSETS;
+extern const AssetEntry ASSETS[];
+extern const Uint8 ASSET_DATA[];
+
+#endif
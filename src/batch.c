@@ -0,0 +1,304 @@
+#include "batch.h"
+#include <SDL2/SDL_version.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+const int INIT_BATCH_CAPACITY = 256;
+const float LINE_HALF_WIDTH = 0.5f; // matches the one pixel SDL lines
+
+#define BATCH_GEOMETRY SDL_VERSION_ATLEAST(2, 0, 18)
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+// Doubles the capacity of an array until it holds at least needed elements
+static int grow_batch(void** items, int* capacity, int needed,
+                      size_t elemSize) {
+    if (needed <= *capacity) {
+        return 1;
+    }
+
+    int grown = *capacity > 0 ? *capacity : INIT_BATCH_CAPACITY;
+    while (grown < needed) {
+        grown *= 2;
+    }
+
+    void* resized = realloc(*items, elemSize * grown);
+    if (!resized) {
+        fprintf(stderr, "Failed to grow render batch!\n");
+        return 0;
+    }
+    *items = resized;
+    *capacity = grown;
+    return 1;
+}
+
+static int reserve_rects(RenderBatch* batch, int needed) {
+    int capacity = batch->rectCapacity;
+    if (!grow_batch((void**)&batch->rects, &capacity, needed,
+                    sizeof(SDL_FRect))) {
+        return 0;
+    }
+    capacity = batch->rectCapacity;
+    if (!grow_batch((void**)&batch->rectColors, &capacity, needed,
+                    sizeof(SDL_Color))) {
+        return 0;
+    }
+    batch->rectCapacity = capacity;
+    return 1;
+}
+
+int init_render_batch(RenderBatch* batch, SDL_Renderer* renderer) {
+    batch->renderer = renderer;
+    batch->color = (SDL_Color){0xFF, 0xFF, 0xFF, 0xFF};
+    batch->numLines = 0;
+    batch->lineCapacity = 0;
+    batch->lines = NULL;
+    batch->numRects = 0;
+    batch->rectCapacity = 0;
+    batch->rects = NULL;
+    batch->rectColors = NULL;
+    batch->vertexCapacity = 0;
+    batch->vertices = NULL;
+    batch->indices = NULL;
+    batch->drawCalls = 0;
+
+    if (!grow_batch((void**)&batch->lines, &batch->lineCapacity,
+                    INIT_BATCH_CAPACITY, sizeof(BatchLine)) ||
+        !reserve_rects(batch, INIT_BATCH_CAPACITY)) {
+        free_render_batch(batch);
+        return 0;
+    }
+    return 1;
+}
+
+void free_render_batch(RenderBatch* batch) {
+    free(batch->lines);
+    free(batch->rects);
+    free(batch->rectColors);
+    free(batch->vertices);
+    free(batch->indices);
+    batch->lines = NULL;
+    batch->rects = NULL;
+    batch->rectColors = NULL;
+    batch->vertices = NULL;
+    batch->indices = NULL;
+    batch->lineCapacity = 0;
+    batch->rectCapacity = 0;
+    batch->vertexCapacity = 0;
+}
+
+void batch_color(RenderBatch* batch, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    batch->color = (SDL_Color){r, g, b, a};
+}
+
+void batch_line(RenderBatch* batch, Vector2 start, Vector2 end) {
+    if (!grow_batch((void**)&batch->lines, &batch->lineCapacity,
+                    batch->numLines + 1, sizeof(BatchLine))) {
+        return;
+    }
+    batch->lines[batch->numLines++] = (BatchLine){start, end, batch->color};
+}
+
+void batch_shape(RenderBatch* batch, const Vector2 points[], int size) {
+    for (int i = 0; i < size - 1; i++) {
+        batch_line(batch, points[i], points[i + 1]);
+    }
+    batch_line(batch, points[0], points[size - 1]);
+}
+
+// As batch_shape() for numShapes outlines of size points each, laid out
+// one after another in points, reserving room once
+void batch_shapes(RenderBatch* batch, const Vector2 points[], int numShapes,
+                  int size) {
+    int numLines = numShapes * size;
+    if (numLines <= 0 ||
+        !grow_batch((void**)&batch->lines, &batch->lineCapacity,
+                    batch->numLines + numLines, sizeof(BatchLine))) {
+        return;
+    }
+    BatchLine* lines = &batch->lines[batch->numLines];
+    for (int s = 0; s < numShapes; s++) {
+        const Vector2* shape = &points[s * size];
+        for (int i = 0; i < size - 1; i++) {
+            *lines++ = (BatchLine){shape[i], shape[i + 1], batch->color};
+        }
+        *lines++ = (BatchLine){shape[0], shape[size - 1], batch->color};
+    }
+    batch->numLines += numLines;
+}
+
+void batch_point(RenderBatch* batch, float x, float y, int thickness) {
+    if (!reserve_rects(batch, batch->numRects + 1)) {
+        return;
+    }
+    // Snapped to whole pixels like the SDL_Rect this replaces
+    float left = (int)x - thickness / 2;
+    float top = (int)y - thickness / 2;
+    float size = thickness;
+    batch->rects[batch->numRects] = (SDL_FRect){left, top, size, size};
+    batch->rectColors[batch->numRects++] = batch->color;
+}
+
+// As batch_point() for a whole run, reserving room once
+void batch_points(RenderBatch* batch, const float* x, const float* y,
+                  int count, int thickness) {
+    if (count <= 0 || !reserve_rects(batch, batch->numRects + count)) {
+        return;
+    }
+    float size = thickness;
+    SDL_FRect* rects = batch->rects + batch->numRects;
+    SDL_Color* colors = batch->rectColors + batch->numRects;
+    for (int i = 0; i < count; i++) {
+        float left = (int)x[i] - thickness / 2;
+        float top = (int)y[i] - thickness / 2;
+        rects[i] = (SDL_FRect){left, top, size, size};
+        colors[i] = batch->color;
+    }
+    batch->numRects += count;
+}
+
+#if BATCH_GEOMETRY
+
+static void set_vertex(SDL_Vertex* vertex, float x, float y,
+                       SDL_Color color) {
+    vertex->position = (SDL_FPoint){x, y};
+    vertex->color = color;
+    vertex->tex_coord = (SDL_FPoint){0, 0};
+}
+
+// Every primitive is a quad, so the index buffer is the same pattern
+// repeated and only needs writing when the vertex buffer grows
+static int reserve_quads(RenderBatch* batch, int numQuads) {
+    int oldCapacity = batch->vertexCapacity;
+    if (!grow_batch((void**)&batch->vertices, &batch->vertexCapacity,
+                    numQuads * 4, sizeof(SDL_Vertex))) {
+        return 0;
+    }
+    if (batch->vertexCapacity == oldCapacity) {
+        return 1;
+    }
+
+    int numIndices = batch->vertexCapacity / 4 * 6;
+    int* indices = (int*)realloc(batch->indices, sizeof(int) * numIndices);
+    if (!indices) {
+        fprintf(stderr, "Failed to grow render batch!\n");
+        batch->vertexCapacity = oldCapacity;
+        return 0;
+    }
+    for (int q = 0; q < batch->vertexCapacity / 4; q++) {
+        int* quad = &indices[q * 6];
+        quad[0] = q * 4;
+        quad[1] = q * 4 + 1;
+        quad[2] = q * 4 + 2;
+        quad[3] = q * 4;
+        quad[4] = q * 4 + 2;
+        quad[5] = q * 4 + 3;
+    }
+    batch->indices = indices;
+    return 1;
+}
+
+// Lines become one pixel wide quads, extended by half a pixel at each end
+// so the corners of outlines stay closed
+static SDL_Vertex* line_quad(SDL_Vertex* quad, const BatchLine* line) {
+    float dX = line->end.x - line->start.x;
+    float dY = line->end.y - line->start.y;
+    float length = sqrtf(dX * dX + dY * dY);
+    if (length <= 0) {
+        dX = LINE_HALF_WIDTH;
+        dY = 0;
+    } else {
+        dX *= LINE_HALF_WIDTH / length;
+        dY *= LINE_HALF_WIDTH / length;
+    }
+
+    float x0 = line->start.x - dX;
+    float y0 = line->start.y - dY;
+    float x1 = line->end.x + dX;
+    float y1 = line->end.y + dY;
+    set_vertex(&quad[0], x0 + dY, y0 - dX, line->color);
+    set_vertex(&quad[1], x1 + dY, y1 - dX, line->color);
+    set_vertex(&quad[2], x1 - dY, y1 + dX, line->color);
+    set_vertex(&quad[3], x0 - dY, y0 + dX, line->color);
+    return quad + 4;
+}
+
+static SDL_Vertex* rect_quad(SDL_Vertex* quad, const SDL_FRect* r,
+                             SDL_Color color) {
+    set_vertex(&quad[0], r->x, r->y, color);
+    set_vertex(&quad[1], r->x + r->w, r->y, color);
+    set_vertex(&quad[2], r->x + r->w, r->y + r->h, color);
+    set_vertex(&quad[3], r->x, r->y + r->h, color);
+    return quad + 4;
+}
+
+static void submit_batch(RenderBatch* batch) {
+    int numQuads = batch->numLines + batch->numRects;
+    if (numQuads == 0 || !reserve_quads(batch, numQuads)) {
+        return;
+    }
+
+    SDL_Vertex* quad = batch->vertices;
+    for (int i = 0; i < batch->numLines; i++) {
+        quad = line_quad(quad, &batch->lines[i]);
+    }
+    for (int i = 0; i < batch->numRects; i++) {
+        quad = rect_quad(quad, &batch->rects[i], batch->rectColors[i]);
+    }
+
+    // Colours travel with the vertices so the whole frame is one call
+    SDL_RenderGeometry(batch->renderer, NULL, batch->vertices, numQuads * 4,
+                       batch->indices, numQuads * 6);
+    batch->drawCalls++;
+}
+
+#else
+
+static int same_color(SDL_Color a, SDL_Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+static void set_draw_color(RenderBatch* batch, SDL_Color color) {
+    SDL_SetRenderDrawColor(batch->renderer, color.r, color.g, color.b,
+                           color.a);
+    batch->drawCalls++;
+}
+
+// Older SDL has no call for disjoint lines, so only the colour changes
+// and the rects are batched
+static void submit_batch(RenderBatch* batch) {
+    for (int i = 0; i < batch->numLines; i++) {
+        const BatchLine* line = &batch->lines[i];
+        if (i == 0 || !same_color(line->color, batch->lines[i - 1].color)) {
+            set_draw_color(batch, line->color);
+        }
+        SDL_RenderDrawLineF(batch->renderer, line->start.x, line->start.y,
+                            line->end.x, line->end.y);
+        batch->drawCalls++;
+    }
+
+    const SDL_Color* colors = batch->rectColors;
+    int runStart = 0;
+    for (int i = 1; i <= batch->numRects; i++) {
+        if (i < batch->numRects && same_color(colors[i], colors[runStart])) {
+            continue;
+        }
+        set_draw_color(batch, colors[runStart]);
+        SDL_RenderFillRectsF(batch->renderer, &batch->rects[runStart],
+                             i - runStart);
+        batch->drawCalls++;
+        runStart = i;
+    }
+}
+
+#endif
+
+void flush_render_batch(RenderBatch* batch) {
+    batch->drawCalls = 0;
+    submit_batch(batch);
+    batch->numLines = 0;
+    batch->numRects = 0;
+}
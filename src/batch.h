@@ -0,0 +1,45 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "vec.h"
+#include <SDL2/SDL_render.h>
+
+// Primitives are queued with the colour that was current when they were
+// added and submitted together by flush_render_batch()
+typedef struct {
+    Vector2 start;
+    Vector2 end;
+    SDL_Color color;
+} BatchLine;
+
+// Per frame queue of lines and filled rects. On SDL 2.0.18 and later the
+// whole queue goes to the driver in a single SDL_RenderGeometry() call.
+typedef struct {
+    SDL_Renderer* renderer;
+    SDL_Color color;
+    int numLines;
+    int lineCapacity;
+    BatchLine* lines;
+    int numRects;
+    int rectCapacity;
+    SDL_FRect* rects;      // kept apart from their colours so runs can go
+    SDL_Color* rectColors; // straight to SDL_RenderFillRectsF()
+    int vertexCapacity;
+    SDL_Vertex* vertices;
+    int* indices;  // fixed quad pattern, only rebuilt when it grows
+    int drawCalls; // SDL submissions made by the last flush
+} RenderBatch;
+
+int init_render_batch(RenderBatch* batch, SDL_Renderer* renderer);
+void free_render_batch(RenderBatch* batch);
+void batch_color(RenderBatch* batch, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+void batch_line(RenderBatch* batch, Vector2 start, Vector2 end);
+void batch_shape(RenderBatch* batch, const Vector2 points[], int size);
+void batch_shapes(RenderBatch* batch, const Vector2 points[], int numShapes,
+                  int size);
+void batch_point(RenderBatch* batch, float x, float y, int thickness);
+void batch_points(RenderBatch* batch, const float* x, const float* y,
+                  int count, int thickness);
+void flush_render_batch(RenderBatch* batch);
+
+#endif
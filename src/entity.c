@@ -0,0 +1,443 @@
+#include "entity.h"
+#include <stdlib.h>
+
+// Grows a single field, leaving it untouched if the allocation fails
+static int grow_field(void** field, size_t elemSize, int capacity) {
+    void* grown = realloc(*field, elemSize * capacity);
+    if (!grown) {
+        return 0;
+    }
+    *field = grown;
+    return 1;
+}
+
+static void init_handles(HandleTable* handles) {
+    handles->numSlots = 0;
+    handles->freeSlot = -1;
+    handles->capacity = 0;
+    handles->generation = NULL;
+    handles->slotDense = NULL;
+    handles->denseSlot = NULL;
+}
+
+static void free_handles(HandleTable* handles) {
+    free(handles->generation);
+    free(handles->slotDense);
+    free(handles->denseSlot);
+    init_handles(handles);
+}
+
+// There are never more slots than live entities, so both sides of the
+// mapping share the capacity of the entity arrays
+static int reserve_handles(HandleTable* handles, int capacity) {
+    if (capacity <= handles->capacity) {
+        return 1;
+    }
+
+    if (!grow_field((void**)&handles->generation, sizeof(Uint32),
+                    capacity) ||
+        !grow_field((void**)&handles->slotDense, sizeof(int), capacity) ||
+        !grow_field((void**)&handles->denseSlot, sizeof(int), capacity)) {
+        return 0;
+    }
+    handles->capacity = capacity;
+    return 1;
+}
+
+static void acquire_handle(HandleTable* handles, int idx) {
+    int slot = handles->freeSlot;
+    if (slot >= 0) {
+        handles->freeSlot = handles->slotDense[slot];
+    } else {
+        slot = handles->numSlots++;
+        handles->generation[slot] = 1; // so a zeroed Handle never resolves
+    }
+    handles->slotDense[slot] = idx;
+    handles->denseSlot[idx] = slot;
+}
+
+// Mirrors the swap remove: idx is released and last moves into its place
+static void release_handle(HandleTable* handles, int idx, int last) {
+    int slot = handles->denseSlot[idx];
+    if (idx != last) {
+        int moved = handles->denseSlot[last];
+        handles->denseSlot[idx] = moved;
+        handles->slotDense[moved] = idx;
+    }
+
+    handles->generation[slot]++;
+    handles->slotDense[slot] = handles->freeSlot;
+    handles->freeSlot = slot;
+}
+
+// Gives entity i slot i after a bulk load. Every slot used before is bumped
+// so handles taken earlier no longer resolve.
+static void reset_handles(HandleTable* handles, int count) {
+    for (int slot = 0; slot < handles->numSlots; slot++) {
+        handles->generation[slot]++;
+    }
+    for (int slot = handles->numSlots; slot < count; slot++) {
+        handles->generation[slot] = 1;
+    }
+    if (count > handles->numSlots) {
+        handles->numSlots = count;
+    }
+
+    handles->freeSlot = -1;
+    for (int slot = handles->numSlots - 1; slot >= count; slot--) {
+        handles->slotDense[slot] = handles->freeSlot;
+        handles->freeSlot = slot;
+    }
+    for (int i = 0; i < count; i++) {
+        handles->slotDense[i] = i;
+        handles->denseSlot[i] = i;
+    }
+}
+
+static Handle handle_of(const HandleTable* handles, int idx) {
+    int slot = handles->denseSlot[idx];
+    return (Handle){(Uint32)slot, handles->generation[slot]};
+}
+
+static int resolve_handle(const HandleTable* handles, Handle handle) {
+    if (handle.slot >= (Uint32)handles->numSlots ||
+        handles->generation[handle.slot] != handle.generation) {
+        return -1;
+    }
+    return handles->slotDense[handle.slot];
+}
+
+int init_asteroid_array(AsteroidArray* asteroids, int capacity) {
+    asteroids->count = 0;
+    asteroids->capacity = 0;
+    asteroids->x = NULL;
+    asteroids->y = NULL;
+    asteroids->vx = NULL;
+    asteroids->vy = NULL;
+    asteroids->px = NULL;
+    asteroids->py = NULL;
+    asteroids->seed = NULL;
+    asteroids->size = NULL;
+    asteroids->shape = NULL;
+    init_handles(&asteroids->handles);
+    return reserve_asteroids(asteroids, capacity);
+}
+
+void free_asteroid_array(AsteroidArray* asteroids) {
+    free(asteroids->x);
+    free(asteroids->y);
+    free(asteroids->vx);
+    free(asteroids->vy);
+    free(asteroids->px);
+    free(asteroids->py);
+    free(asteroids->seed);
+    free(asteroids->size);
+    free(asteroids->shape);
+    free_handles(&asteroids->handles);
+    asteroids->count = 0;
+    asteroids->capacity = 0;
+}
+
+int reserve_asteroids(AsteroidArray* asteroids, int capacity) {
+    if (capacity <= asteroids->capacity) {
+        return 1;
+    }
+
+    if (!grow_field((void**)&asteroids->x, sizeof(float), capacity) ||
+        !grow_field((void**)&asteroids->y, sizeof(float), capacity) ||
+        !grow_field((void**)&asteroids->vx, sizeof(float), capacity) ||
+        !grow_field((void**)&asteroids->vy, sizeof(float), capacity) ||
+        !grow_field((void**)&asteroids->px, sizeof(float), capacity) ||
+        !grow_field((void**)&asteroids->py, sizeof(float), capacity) ||
+        !grow_field((void**)&asteroids->seed, sizeof(Uint32), capacity) ||
+        !grow_field((void**)&asteroids->size, sizeof(AsteroidSize),
+                    capacity) ||
+        !grow_field((void**)&asteroids->shape, sizeof(AsteroidShape),
+                    capacity) ||
+        !reserve_handles(&asteroids->handles, capacity)) {
+        return 0;
+    }
+    asteroids->capacity = capacity;
+    return 1;
+}
+
+int push_asteroid(AsteroidArray* asteroids, Vector2 position,
+                  Vector2 velocity, AsteroidSize size, Uint32 seed,
+                  const AsteroidShape* shape) {
+    if (asteroids->count == asteroids->capacity &&
+        !reserve_asteroids(asteroids, asteroids->capacity * 2 + 1)) {
+        return -1;
+    }
+
+    int idx = asteroids->count++;
+    asteroids->x[idx] = position.x;
+    asteroids->y[idx] = position.y;
+    asteroids->vx[idx] = velocity.x;
+    asteroids->vy[idx] = velocity.y;
+    asteroids->px[idx] = position.x;
+    asteroids->py[idx] = position.y;
+    asteroids->seed[idx] = seed;
+    asteroids->size[idx] = size;
+    asteroids->shape[idx] = *shape;
+    acquire_handle(&asteroids->handles, idx);
+    return idx;
+}
+
+// Swap the last asteroid into the hole so removal is constant time
+void remove_asteroid(AsteroidArray* asteroids, int idx) {
+    int last = --asteroids->count;
+    release_handle(&asteroids->handles, idx, last);
+    asteroids->x[idx] = asteroids->x[last];
+    asteroids->y[idx] = asteroids->y[last];
+    asteroids->vx[idx] = asteroids->vx[last];
+    asteroids->vy[idx] = asteroids->vy[last];
+    asteroids->px[idx] = asteroids->px[last];
+    asteroids->py[idx] = asteroids->py[last];
+    asteroids->seed[idx] = asteroids->seed[last];
+    asteroids->size[idx] = asteroids->size[last];
+    asteroids->shape[idx] = asteroids->shape[last];
+}
+
+// Sets the number of asteroids for a bulk load, leaving every field for
+// the caller to fill in
+int resize_asteroids(AsteroidArray* asteroids, int count) {
+    if (!reserve_asteroids(asteroids, count)) {
+        return 0;
+    }
+    asteroids->count = count;
+    reset_handles(&asteroids->handles, count);
+    return 1;
+}
+
+Handle asteroid_handle(const AsteroidArray* asteroids, int idx) {
+    return handle_of(&asteroids->handles, idx);
+}
+
+int resolve_asteroid(const AsteroidArray* asteroids, Handle handle) {
+    return resolve_handle(&asteroids->handles, handle);
+}
+
+int init_projectile_array(ProjectileArray* projectiles, int capacity) {
+    projectiles->count = 0;
+    projectiles->capacity = 0;
+    projectiles->x = NULL;
+    projectiles->y = NULL;
+    projectiles->vx = NULL;
+    projectiles->vy = NULL;
+    projectiles->px = NULL;
+    projectiles->py = NULL;
+    projectiles->spawnTime = NULL;
+    init_handles(&projectiles->handles);
+    return reserve_projectiles(projectiles, capacity);
+}
+
+void free_projectile_array(ProjectileArray* projectiles) {
+    free(projectiles->x);
+    free(projectiles->y);
+    free(projectiles->vx);
+    free(projectiles->vy);
+    free(projectiles->px);
+    free(projectiles->py);
+    free(projectiles->spawnTime);
+    free_handles(&projectiles->handles);
+    projectiles->count = 0;
+    projectiles->capacity = 0;
+}
+
+int reserve_projectiles(ProjectileArray* projectiles, int capacity) {
+    if (capacity <= projectiles->capacity) {
+        return 1;
+    }
+
+    if (!grow_field((void**)&projectiles->x, sizeof(float), capacity) ||
+        !grow_field((void**)&projectiles->y, sizeof(float), capacity) ||
+        !grow_field((void**)&projectiles->vx, sizeof(float), capacity) ||
+        !grow_field((void**)&projectiles->vy, sizeof(float), capacity) ||
+        !grow_field((void**)&projectiles->px, sizeof(float), capacity) ||
+        !grow_field((void**)&projectiles->py, sizeof(float), capacity) ||
+        !grow_field((void**)&projectiles->spawnTime, sizeof(Uint32),
+                    capacity) ||
+        !reserve_handles(&projectiles->handles, capacity)) {
+        return 0;
+    }
+    projectiles->capacity = capacity;
+    return 1;
+}
+
+int push_projectile(ProjectileArray* projectiles, Vector2 position,
+                    Vector2 velocity, Uint32 spawnTime) {
+    if (projectiles->count == projectiles->capacity &&
+        !reserve_projectiles(projectiles, projectiles->capacity * 2 + 1)) {
+        return -1;
+    }
+
+    int idx = projectiles->count++;
+    projectiles->x[idx] = position.x;
+    projectiles->y[idx] = position.y;
+    projectiles->vx[idx] = velocity.x;
+    projectiles->vy[idx] = velocity.y;
+    projectiles->px[idx] = position.x;
+    projectiles->py[idx] = position.y;
+    projectiles->spawnTime[idx] = spawnTime;
+    acquire_handle(&projectiles->handles, idx);
+    return idx;
+}
+
+// Swap the last projectile into the hole so removal is constant time
+void remove_projectile(ProjectileArray* projectiles, int idx) {
+    int last = --projectiles->count;
+    release_handle(&projectiles->handles, idx, last);
+    projectiles->x[idx] = projectiles->x[last];
+    projectiles->y[idx] = projectiles->y[last];
+    projectiles->vx[idx] = projectiles->vx[last];
+    projectiles->vy[idx] = projectiles->vy[last];
+    projectiles->px[idx] = projectiles->px[last];
+    projectiles->py[idx] = projectiles->py[last];
+    projectiles->spawnTime[idx] = projectiles->spawnTime[last];
+}
+
+// Releases every projectile without giving back any memory
+void clear_projectiles(ProjectileArray* projectiles) {
+    while (projectiles->count > 0) {
+        remove_projectile(projectiles, projectiles->count - 1);
+    }
+}
+
+int resize_projectiles(ProjectileArray* projectiles, int count) {
+    if (!reserve_projectiles(projectiles, count)) {
+        return 0;
+    }
+    projectiles->count = count;
+    reset_handles(&projectiles->handles, count);
+    return 1;
+}
+
+Handle projectile_handle(const ProjectileArray* projectiles, int idx) {
+    return handle_of(&projectiles->handles, idx);
+}
+
+int resolve_projectile(const ProjectileArray* projectiles, Handle handle) {
+    return resolve_handle(&projectiles->handles, handle);
+}
+
+int init_alien_array(AlienArray* aliens, int capacity) {
+    aliens->count = 0;
+    aliens->capacity = 0;
+    aliens->x = NULL;
+    aliens->y = NULL;
+    aliens->px = NULL;
+    aliens->py = NULL;
+    aliens->rotation = NULL;
+    aliens->nextShot = NULL;
+    return reserve_aliens(aliens, capacity);
+}
+
+void free_alien_array(AlienArray* aliens) {
+    free(aliens->x);
+    free(aliens->y);
+    free(aliens->px);
+    free(aliens->py);
+    free(aliens->rotation);
+    free(aliens->nextShot);
+    aliens->count = 0;
+    aliens->capacity = 0;
+}
+
+int reserve_aliens(AlienArray* aliens, int capacity) {
+    if (capacity <= aliens->capacity) {
+        return 1;
+    }
+
+    if (!grow_field((void**)&aliens->x, sizeof(float), capacity) ||
+        !grow_field((void**)&aliens->y, sizeof(float), capacity) ||
+        !grow_field((void**)&aliens->px, sizeof(float), capacity) ||
+        !grow_field((void**)&aliens->py, sizeof(float), capacity) ||
+        !grow_field((void**)&aliens->rotation, sizeof(float), capacity) ||
+        !grow_field((void**)&aliens->nextShot, sizeof(Uint32), capacity)) {
+        return 0;
+    }
+    aliens->capacity = capacity;
+    return 1;
+}
+
+int push_alien(AlienArray* aliens, Vector2 position, Uint32 nextShot) {
+    if (aliens->count == aliens->capacity &&
+        !reserve_aliens(aliens, aliens->capacity * 2 + 1)) {
+        return -1;
+    }
+
+    int idx = aliens->count++;
+    aliens->x[idx] = position.x;
+    aliens->y[idx] = position.y;
+    aliens->px[idx] = position.x;
+    aliens->py[idx] = position.y;
+    aliens->rotation[idx] = 0;
+    aliens->nextShot[idx] = nextShot;
+    return idx;
+}
+
+// Swap the last alien into the hole so removal is constant time
+void remove_alien(AlienArray* aliens, int idx) {
+    int last = --aliens->count;
+    aliens->x[idx] = aliens->x[last];
+    aliens->y[idx] = aliens->y[last];
+    aliens->px[idx] = aliens->px[last];
+    aliens->py[idx] = aliens->py[last];
+    aliens->rotation[idx] = aliens->rotation[last];
+    aliens->nextShot[idx] = aliens->nextShot[last];
+}
+
+int resize_aliens(AlienArray* aliens, int count) {
+    if (!reserve_aliens(aliens, count)) {
+        return 0;
+    }
+    aliens->count = count;
+    return 1;
+}
+
+int init_handle_list(HandleList* list, int capacity) {
+    list->count = 0;
+    list->capacity = 0;
+    list->items = NULL;
+    if (!grow_field((void**)&list->items, sizeof(Handle), capacity)) {
+        return 0;
+    }
+    list->capacity = capacity;
+    return 1;
+}
+
+void free_handle_list(HandleList* list) {
+    free(list->items);
+    list->items = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+// Grows at least geometrically, so reserving a little more each tick does
+// not reallocate each tick
+int reserve_handle_list(HandleList* list, int capacity) {
+    if (capacity <= list->capacity) {
+        return 1;
+    }
+    int grown = list->capacity * 2;
+    if (grown < capacity) {
+        grown = capacity;
+    }
+    if (!grow_field((void**)&list->items, sizeof(Handle), grown)) {
+        return 0;
+    }
+    list->capacity = grown;
+    return 1;
+}
+
+int push_handle(HandleList* list, Handle handle) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity * 2 + 1;
+        if (!grow_field((void**)&list->items, sizeof(Handle), capacity)) {
+            return 0;
+        }
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = handle;
+    return 1;
+}
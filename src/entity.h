@@ -0,0 +1,134 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+#include "vec.h"
+#include <SDL2/SDL_stdinc.h>
+
+typedef enum {
+    SMALL = 5,
+    MEDIUM = 9,
+    LARGE = 12,
+} AsteroidSize;
+
+#define MAX_ASTEROID_POINTS 13 // vertices in the outline of a large asteroid
+#define ASTEROID_LANES 16 // MAX_ASTEROID_POINTS rounded up to whole vectors
+
+// Outline in local space around the asteroid centre. Built once at spawn and
+// shared by drawing and collision. Stored as columns with every lane from
+// numPoints on repeating the first vertex, so edge i runs from lane i to
+// lane i + 1 and the collision loops run a fixed ASTEROID_LANES edges with
+// no remainder, the padding edges having zero length.
+typedef struct {
+    int numPoints;
+    float radius; // distance to the furthest vertex
+    float x[ASTEROID_LANES + 1];
+    float y[ASTEROID_LANES + 1];
+} AsteroidShape;
+
+// Stable reference to a pooled entity. The generation is bumped every time
+// the slot is released, so a handle to a removed entity no longer resolves.
+typedef struct {
+    Uint32 slot;
+    Uint32 generation;
+} Handle;
+
+// Maps stable handle slots to dense array indices and back. Released slots
+// are reused through a free list threaded through slotDense.
+typedef struct {
+    int numSlots;
+    int freeSlot;       // -1 when no released slot is available
+    int capacity;
+    Uint32* generation; // per slot
+    int* slotDense;     // dense index, or next free slot once released
+    int* denseSlot;     // slot of each live entity
+} HandleTable;
+
+typedef struct {
+    int count;
+    int capacity;
+    Handle* items;
+} HandleList;
+
+// Asteroids stored as parallel arrays so update and collision loops stream
+// through memory instead of chasing a pointer per asteroid
+typedef struct {
+    int count;
+    int capacity;
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* px; // position at the start of the current tick, for rendering
+    float* py;
+    Uint32* seed;
+    AsteroidSize* size;
+    AsteroidShape* shape; // only touched when drawing or in narrowphase
+    HandleTable handles;
+} AsteroidArray;
+
+typedef struct {
+    int count;
+    int capacity;
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* px;
+    float* py;
+    Uint32* spawnTime;
+    HandleTable handles;
+} ProjectileArray;
+
+// Aliens as parallel arrays too, so one pass steers, aims and times the
+// fire of every alien. Nothing holds on to an alien between ticks, so
+// there is no handle table.
+typedef struct {
+    int count;
+    int capacity;
+    float* x;
+    float* y;
+    float* px; // position at the start of the current tick, for rendering
+    float* py;
+    float* rotation;  // shoot angle
+    Uint32* nextShot; // time the alien may fire again
+} AlienArray;
+
+// Arrays grow geometrically and never shrink, so once play reaches its high
+// water mark adding and removing entities no longer touches the heap
+
+int init_asteroid_array(AsteroidArray* asteroids, int capacity);
+void free_asteroid_array(AsteroidArray* asteroids);
+int reserve_asteroids(AsteroidArray* asteroids, int capacity);
+int push_asteroid(AsteroidArray* asteroids, Vector2 position,
+                  Vector2 velocity, AsteroidSize size, Uint32 seed,
+                  const AsteroidShape* shape);
+void remove_asteroid(AsteroidArray* asteroids, int idx);
+int resize_asteroids(AsteroidArray* asteroids, int count);
+Handle asteroid_handle(const AsteroidArray* asteroids, int idx);
+// Returns the current index of the asteroid, or -1 if it has been removed
+int resolve_asteroid(const AsteroidArray* asteroids, Handle handle);
+
+int init_projectile_array(ProjectileArray* projectiles, int capacity);
+void free_projectile_array(ProjectileArray* projectiles);
+int reserve_projectiles(ProjectileArray* projectiles, int capacity);
+int push_projectile(ProjectileArray* projectiles, Vector2 position,
+                    Vector2 velocity, Uint32 spawnTime);
+void remove_projectile(ProjectileArray* projectiles, int idx);
+void clear_projectiles(ProjectileArray* projectiles);
+int resize_projectiles(ProjectileArray* projectiles, int count);
+Handle projectile_handle(const ProjectileArray* projectiles, int idx);
+int resolve_projectile(const ProjectileArray* projectiles, Handle handle);
+
+int init_alien_array(AlienArray* aliens, int capacity);
+void free_alien_array(AlienArray* aliens);
+int reserve_aliens(AlienArray* aliens, int capacity);
+int push_alien(AlienArray* aliens, Vector2 position, Uint32 nextShot);
+void remove_alien(AlienArray* aliens, int idx);
+int resize_aliens(AlienArray* aliens, int count);
+
+int init_handle_list(HandleList* list, int capacity);
+void free_handle_list(HandleList* list);
+int reserve_handle_list(HandleList* list, int capacity);
+int push_handle(HandleList* list, Handle handle);
+
+#endif
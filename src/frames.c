@@ -0,0 +1,43 @@
+#include "frames.h"
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+void init_frame_buffer(FrameBuffer* frames) {
+    for (int i = 0; i < NUM_FRAME_SLOTS; i++) {
+        init_snapshot(&frames->slots[i].view);
+        frames->slots[i].tick = 0;
+        frames->slots[i].time = 0;
+        frames->slots[i].counter = 0;
+    }
+    frames->back = 0;
+    SDL_AtomicSet(&frames->latest, 1);
+    frames->front = 2;
+}
+
+// Only once both threads are done with it
+void free_frame_buffer(FrameBuffer* frames) {
+    for (int i = 0; i < NUM_FRAME_SLOTS; i++) {
+        free_snapshot(&frames->slots[i].view);
+    }
+}
+
+SimFrame* back_frame(FrameBuffer* frames) {
+    return &frames->slots[frames->back];
+}
+
+// The swap is a full barrier, so the reader sees the whole frame
+void publish_frame(FrameBuffer* frames) {
+    int old = SDL_AtomicSet(&frames->latest, frames->back | FRAME_FRESH);
+    frames->back = old & FRAME_INDEX_MASK;
+}
+
+// Returns NULL until the first frame has been published. The frame stays
+// valid until the next call.
+const SimFrame* latest_frame(FrameBuffer* frames) {
+    if (SDL_AtomicGet(&frames->latest) & FRAME_FRESH) {
+        int old = SDL_AtomicSet(&frames->latest, frames->front);
+        frames->front = old & FRAME_INDEX_MASK;
+    }
+    const SimFrame* frame = &frames->slots[frames->front];
+    return frame->view.size > 0 ? frame : NULL;
+}
@@ -0,0 +1,38 @@
+#ifndef FRAMES_H
+#define FRAMES_H
+
+#include "snapshot.h"
+#include <SDL2/SDL_atomic.h>
+
+#define NUM_FRAME_SLOTS 3
+#define FRAME_FRESH 0x4 // set in latest until the reader takes the frame
+#define FRAME_INDEX_MASK 0x3
+
+// One simulated tick as the renderer sees it. The view never changes once
+// published, so it is read without holding anything.
+typedef struct {
+    Snapshot view; // from save_view()
+    Uint64 tick;
+    Uint32 time;    // simulation clock at the end of the tick, in ms
+    Uint64 counter; // performance counter when the tick was published
+} SimFrame;
+
+// Triple buffer between one writer and one reader. The writer fills its
+// back slot and swaps it with the shared latest one, the reader swaps its
+// front slot for latest when that is fresh. Each side only ever touches
+// its own slot, so neither waits on the other and the reader always gets
+// the newest complete tick.
+typedef struct {
+    SimFrame slots[NUM_FRAME_SLOTS];
+    SDL_atomic_t latest; // slot index, plus FRAME_FRESH when unread
+    int back;            // writer side only
+    int front;           // reader side only
+} FrameBuffer;
+
+void init_frame_buffer(FrameBuffer* frames);
+void free_frame_buffer(FrameBuffer* frames);
+SimFrame* back_frame(FrameBuffer* frames);
+void publish_frame(FrameBuffer* frames);
+const SimFrame* latest_frame(FrameBuffer* frames);
+
+#endif
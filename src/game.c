@@ -0,0 +1,1026 @@
+#include "game.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*-----------------------------------STRUCTS----------------------------------*/
+
+// Arguments of the parallel phases, filled on the calling thread
+typedef struct {
+    float* x;
+    float* y;
+    const float* vx;
+    const float* vy;
+    float deltaTime;
+    int wrap;
+} MoveJob;
+
+// One shot's movement over the tick, ending at (x, y)
+typedef struct {
+    float x;
+    float y;
+    float dx;
+    float dy;
+} Sweep;
+
+typedef struct {
+    const State* state;
+    int* hits;
+    Uint64 tests[MAX_JOB_THREADS];
+    float reach[MAX_JOB_THREADS]; // longest squared step of any shot
+} ShotJob;
+
+typedef struct {
+    const ProjectileArray* shots;
+    Vector2 target;
+    float radius;
+    int hits[MAX_JOB_THREADS];
+} CrashJob;
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+void update_state(State* state, Uint8 input, Time* gameTime) {
+    float deltaTime = gameTime->deltaTime;
+    Profiler* profiler = state->profiler;
+    save_previous(state);
+
+    Uint64 start = profile_begin(profiler, PHASE_PLAYER);
+    apply_input(state->player, input, deltaTime);
+    update_player(state->player, deltaTime);
+    update_shoot(state, gameTime);
+    profile_end(profiler, PHASE_PLAYER, start);
+
+    start = profile_begin(profiler, PHASE_ASTEROIDS);
+    drain_spawns(state, SPAWN_BUDGET);
+    update_asteroids(&state->asteroids, deltaTime, state->jobs);
+    profile_end(profiler, PHASE_ASTEROIDS, start);
+
+    // Aliens fire before the shots move, so like the player's their new
+    // shots leave the muzzle this tick
+    start = profile_begin(profiler, PHASE_ALIEN);
+    update_aliens(state, gameTime);
+    profile_end(profiler, PHASE_ALIEN, start);
+
+    start = profile_begin(profiler, PHASE_PROJECTILES);
+    update_projectiles(&state->projectiles, deltaTime, state->jobs);
+    update_projectiles(&state->alienProjs, deltaTime, state->jobs);
+    delete_projectiles(state, gameTime->time);
+    profile_end(profiler, PHASE_PROJECTILES, start);
+
+    start = profile_begin(profiler, PHASE_SHOTS);
+    detect_Shoot(state);
+    profile_end(profiler, PHASE_SHOTS, start);
+
+    // The level is clear once the last queued asteroid is out and shot
+    if (state->asteroids.count <= 0 && state->spawns.count == 0) {
+        state->level++;
+        queue_asteroids(state, state->level * INIT_NUM_ASTEROIDS);
+        state->aliens.count = 0;
+        spawn_aliens(state, aliens_for_level(state->level), gameTime->time);
+        queue_sound(state->sounds, SOUND_RAN);
+    }
+
+    if (!state->player->crashed) {
+        start = profile_begin(profiler, PHASE_CRASH);
+        detect_crash(state, gameTime->time);
+        profile_end(profiler, PHASE_CRASH, start);
+    }
+
+    if (state->player->crashed &&
+        (gameTime->time - state->player->crashTime) >= RESPAWN_TIME) {
+        respawn(state->player);
+    }
+
+    start = profile_begin(profiler, PHASE_PARTICLES);
+    update_particles(&state->particles, deltaTime);
+    profile_end(profiler, PHASE_PARTICLES, start);
+}
+
+// Simulation clock in ms after a number of fixed ticks. Derived from the
+// tick count rather than summed so it never drifts.
+Uint32 tick_time(Uint64 tick, float deltaTime) {
+    return (Uint32)(tick * ((double)deltaTime * MS_TO_SECONDS));
+}
+
+static void save_positions(float* px, float* py, const float* x,
+                           const float* y, int count) {
+    memcpy(px, x, sizeof(float) * count);
+    memcpy(py, y, sizeof(float) * count);
+}
+
+// Keeps the state at the start of the tick so rendering can interpolate
+// between it and the state at the end
+void save_previous(State* state) {
+    AsteroidArray* asteroids = &state->asteroids;
+    ProjectileArray* projectiles = &state->projectiles;
+    ProjectileArray* alienProjs = &state->alienProjs;
+    AlienArray* aliens = &state->aliens;
+
+    state->player->prevPosition = state->player->position;
+    state->player->prevRotation = state->player->rotation;
+    save_positions(aliens->px, aliens->py, aliens->x, aliens->y,
+                   aliens->count);
+    save_positions(asteroids->px, asteroids->py, asteroids->x, asteroids->y,
+                   asteroids->count);
+    save_positions(projectiles->px, projectiles->py, projectiles->x,
+                   projectiles->y, projectiles->count);
+    save_positions(alienProjs->px, alienProjs->py, alienProjs->x,
+                   alienProjs->y, alienProjs->count);
+}
+
+void apply_input(Player* player, Uint8 input, float deltaTime) {
+    if (player->crashed) {
+        return;
+    }
+
+    // Forward movement/thrusters
+    if (input & INPUT_THRUST) {
+        float dX = cos(player->rotation) * -PLAYER_SPEED * deltaTime;
+        float dY = sin(player->rotation) * -PLAYER_SPEED * deltaTime;
+        Vector2 movement = create_vector(dX, dY);
+        player->moving = 1;
+        player->velocity = vector_sum(player->velocity, movement);
+    } else {
+        player->moving = 0; // Set the moving flag back to 0
+    }
+
+    // Rotation left
+    if (input & INPUT_LEFT) {
+        player->rotation -= PLAYER_ROTATION_RATE * deltaTime;
+    }
+
+    // Rotation right
+    if (input & INPUT_RIGHT) {
+        player->rotation += PLAYER_ROTATION_RATE * deltaTime;
+    }
+
+    if (input & INPUT_SHOOT) {
+        player->shoot = 1;
+    }
+}
+
+Player* init_ship(const float x, const float y) {
+    Player* player = (Player*)malloc(sizeof(Player));
+    player->moving = 0;
+    player->shoot = 0;
+    player->crashed = 0;
+    player->crashTime = 0;
+    player->position = (Vector2){x, y};
+    player->velocity = (Vector2){0, 0};
+    player->rotation = VERTICLE;
+    player->prevPosition = player->position;
+    player->prevRotation = player->rotation;
+    player->lastShot = 0;
+    return player;
+}
+
+State* init_state(void) {
+    State* state = (State*)malloc(sizeof(State));
+    if (!state) {
+        fprintf(stderr, "Failed to allocate game state!\n");
+        return NULL;
+    }
+
+    state->score = 0;
+    state->level = 1;
+    seed_state(state, 0); // callers reseed before spawning
+    state->player = init_ship(SCREEN_WIDTH / 2.0, SCREEN_HEIGHT / 2.0);
+    if (!state->player) {
+        fprintf(stderr, "Failed to initialize player!\n");
+        free(state);
+        return NULL;
+    }
+
+    if (!init_alien_array(&state->aliens, INIT_CAPACITY)) {
+        fprintf(stderr, "Failed to allocate aliens array!\n");
+        free_alien_array(&state->aliens);
+        free_player(state->player);
+        free(state);
+        return NULL;
+    }
+
+    if (!init_asteroid_array(&state->asteroids, INIT_CAPACITY)) {
+        fprintf(stderr, "Failed to allocate asteroids array!\n");
+        free_alien_array(&state->aliens);
+        free_player(state->player);
+        free(state);
+        return NULL;
+    }
+
+    if (!init_particles(&state->particles)) {
+        free_asteroid_array(&state->asteroids);
+        free_alien_array(&state->aliens);
+        free_player(state->player);
+        free(state);
+        return NULL;
+    }
+
+    if (!init_projectile_array(&state->projectiles, INIT_CAPACITY)) {
+        fprintf(stderr, "Failed to allocate projectiles array!\n");
+        free_particles(&state->particles);
+        free_asteroid_array(&state->asteroids);
+        free_alien_array(&state->aliens);
+        free_player(state->player);
+        free(state);
+        return NULL;
+    }
+
+    if (!init_projectile_array(&state->alienProjs, INIT_CAPACITY)) {
+        fprintf(stderr, "Failed to allocate projectiles array!\n");
+        free_projectile_array(&state->projectiles);
+        free_particles(&state->particles);
+        free_asteroid_array(&state->asteroids);
+        free_alien_array(&state->aliens);
+        free_player(state->player);
+        free(state);
+        return NULL;
+    }
+
+    state->pairTests = 0;
+    if (!init_grid(&state->asteroidGrid, SCREEN_WIDTH, SCREEN_HEIGHT,
+                   GRID_CELL_SIZE) ||
+        !init_grid(&state->projectileGrid, SCREEN_WIDTH, SCREEN_HEIGHT,
+                   GRID_CELL_SIZE)) {
+        fprintf(stderr, "Failed to allocate collision grids!\n");
+        free_grid(&state->asteroidGrid);
+        free_projectile_array(&state->alienProjs);
+        free_projectile_array(&state->projectiles);
+        free_particles(&state->particles);
+        free_asteroid_array(&state->asteroids);
+        free_alien_array(&state->aliens);
+        free_player(state->player);
+        free(state);
+        return NULL;
+    }
+
+    if (!init_handle_list(&state->destroyed, INIT_CAPACITY)) {
+        fprintf(stderr, "Failed to allocate destroyed list!\n");
+        free_grid(&state->projectileGrid);
+        free_grid(&state->asteroidGrid);
+        free_projectile_array(&state->alienProjs);
+        free_projectile_array(&state->projectiles);
+        free_particles(&state->particles);
+        free_asteroid_array(&state->asteroids);
+        free_alien_array(&state->aliens);
+        free_player(state->player);
+        free(state);
+        return NULL;
+    }
+
+    // Grown on the first tick with projectiles or spawns
+    state->shotHits = NULL;
+    state->shotCapacity = 0;
+    state->spawns.head = 0;
+    state->spawns.count = 0;
+    state->spawns.capacity = 0;
+    state->spawns.items = NULL;
+
+    // Sounds, the profiler and workers are attached by the caller
+    state->sounds = NULL;
+    state->profiler = NULL;
+    state->jobs = NULL;
+
+    return state;
+}
+
+void free_player(Player* player) { free(player); }
+
+void free_state(State* state) {
+    free_player(state->player);
+    free_alien_array(&state->aliens);
+    free_particles(&state->particles);
+    free_soundmanager(state->sounds);
+    free_asteroid_array(&state->asteroids);
+    free_projectile_array(&state->projectiles);
+    free_projectile_array(&state->alienProjs);
+    free_grid(&state->asteroidGrid);
+    free_grid(&state->projectileGrid);
+    free_handle_list(&state->destroyed);
+    free(state->shotHits);
+    free(state->spawns.items);
+    free(state);
+}
+
+void update_player(Player* player, float deltaTime) {
+    // Ensure there is a constant frictional/drag on the ship
+    player->velocity =
+        vector_mul(player->velocity, (1.0f - PLAYER_DRAG * deltaTime));
+
+    float newX = player->position.x + player->velocity.x * deltaTime;
+    float newY = player->position.y + player->velocity.y * deltaTime;
+    newX = wrap_coordinate(newX, SCREEN_WIDTH);
+    newY = wrap_coordinate(newY, SCREEN_HEIGHT);
+
+    player->position = create_vector(newX, newY);
+}
+
+// Same seed gives the same run: all gameplay randomness comes from rng and
+// everything purely visual from fxRng
+void seed_state(State* state, Uint64 seed) {
+    seed_rng(&state->rng, seed, RNG_STREAM_GAMEPLAY);
+    seed_rng(&state->fxRng, seed, RNG_STREAM_COSMETIC);
+}
+
+int add_asteroid(State* state, AsteroidSize size, Vector2 position,
+                 Uint32 seed) {
+    int idx = asteroid_size_idx(size);
+    float speed = rng_float(&state->rng, MIN_ASTEROID_SPEEDS[idx],
+                            MAX_ASTEROID_SPEEDS[idx]);
+    float angle = rng_float(&state->rng, 0, (2.0f * M_PI)); // Any angle
+    float dX = cos(angle) * speed;
+    float dY = sin(angle) * speed;
+    Vector2 velocity = create_vector(dX, dY);
+
+    AsteroidShape shape;
+    build_asteroid_shape(&shape, size, seed);
+    return push_asteroid(&state->asteroids, position, velocity, size, seed,
+                         &shape);
+}
+
+// The outline depends only on the asteroid seed, through a generator of its
+// own, so it can be rebuilt at any time without touching the state streams
+void build_asteroid_shape(AsteroidShape* shape, AsteroidSize size,
+                          Uint32 seed) {
+    int idx = asteroid_size_idx(size);
+    int numPoints = ASTEROID_POINTS[idx];
+    float angleStep = (2 * M_PI) / (float)numPoints; // get the step of each
+
+    Rng rng;
+    seed_rng(&rng, seed, RNG_STREAM_SHAPE);
+    float radii[MAX_ASTEROID_POINTS];
+    rng_fill_floats(&rng, radii, numPoints, MIN_RADIUS, MAX_RADIUS);
+
+    shape->numPoints = numPoints;
+    shape->radius = 0;
+    for (int i = 0; i < numPoints; i++) {
+        float radius = ASTEROID_SIZES[idx] * radii[i];
+        float angle = angleStep * i;
+        shape->x[i] = cos(angle) * radius;
+        shape->y[i] = sin(angle) * radius;
+        if (radius > shape->radius) {
+            shape->radius = radius;
+        }
+    }
+    for (int i = numPoints; i <= ASTEROID_LANES; i++) {
+        shape->x[i] = shape->x[0];
+        shape->y[i] = shape->y[0];
+    }
+}
+
+static void move_job(void* data, int begin, int end, int thread) {
+    (void)thread;
+    MoveJob* job = (MoveJob*)data;
+    if (job->wrap) {
+        integrate_wrap(&job->x[begin], &job->y[begin], &job->vx[begin],
+                       &job->vy[begin], end - begin, job->deltaTime,
+                       SCREEN_WIDTH, SCREEN_HEIGHT);
+    } else {
+        integrate(&job->x[begin], &job->y[begin], &job->vx[begin],
+                  &job->vy[begin], end - begin, job->deltaTime);
+    }
+}
+
+void update_asteroids(AsteroidArray* asteroids, float deltaTime,
+                      JobSystem* jobs) {
+    MoveJob job = {asteroids->x, asteroids->y, asteroids->vx,
+                   asteroids->vy, deltaTime, 1};
+    run_jobs(jobs, move_job, &job, asteroids->count, MOVE_CHUNK);
+}
+
+// Adds them all at once, for setting up a game before the first tick
+void spawn_asteroids(State* state, int num) {
+    queue_asteroids(state, num);
+    drain_spawns(state, state->spawns.count);
+}
+
+// Geometric growth, so adding a few fragments a tick rarely reallocates
+static int grow_asteroids(AsteroidArray* asteroids, int needed) {
+    if (needed <= asteroids->capacity) {
+        return 1;
+    }
+    int capacity = asteroids->capacity * 2;
+    return reserve_asteroids(asteroids, capacity > needed ? capacity : needed);
+}
+
+// Makes room for extra more requests after the live ones. They are only
+// moved to the front once the end of the array is in the way, and the
+// array only grows if that is not enough.
+static int reserve_spawns(SpawnQueue* queue, int extra) {
+    if (queue->head + queue->count + extra <= queue->capacity) {
+        return 1;
+    }
+    if (queue->head > 0) {
+        memmove(queue->items, queue->items + queue->head,
+                sizeof(SpawnRequest) * queue->count);
+        queue->head = 0;
+    }
+    int needed = queue->count + extra;
+    if (needed <= queue->capacity) {
+        return 1;
+    }
+    int capacity = queue->capacity * 2;
+    if (capacity < needed) {
+        capacity = needed;
+    }
+    SpawnRequest* items =
+        (SpawnRequest*)realloc(queue->items, sizeof(SpawnRequest) * capacity);
+    if (!items) {
+        return 0;
+    }
+    queue->items = items;
+    queue->capacity = capacity;
+    return 1;
+}
+
+// Sets the number of queued requests for a bulk load, leaving them for the
+// caller to fill in
+int resize_spawns(SpawnQueue* queue, int count) {
+    queue->head = 0;
+    queue->count = 0;
+    if (!reserve_spawns(queue, count)) {
+        return 0;
+    }
+    queue->count = count;
+    return 1;
+}
+
+void queue_asteroid(State* state, AsteroidSize size, Vector2 position) {
+    SpawnQueue* queue = &state->spawns;
+    if (queue->head + queue->count == queue->capacity &&
+        !reserve_spawns(queue, 1)) {
+        fprintf(stderr, "Failed to queue asteroid!\n");
+        return;
+    }
+    SpawnRequest* request = &queue->items[queue->head + queue->count++];
+    request->size = size;
+    request->position = position;
+    request->seed = rng_next(&state->rng);
+}
+
+// A new level of large asteroids. Room for all of them is reserved here,
+// so draining them later never grows an array.
+void queue_asteroids(State* state, int num) {
+    SpawnQueue* queue = &state->spawns;
+    if (!reserve_spawns(queue, num) ||
+        !grow_asteroids(&state->asteroids,
+                        state->asteroids.count + queue->count + num)) {
+        fprintf(stderr, "Failed to queue asteroids!\n");
+        return;
+    }
+
+    // Positions are drawn a chunk at a time with the batch fill
+    float xs[SPAWN_CHUNK];
+    float ys[SPAWN_CHUNK];
+    for (int start = 0; start < num; start += SPAWN_CHUNK) {
+        int count = num - start < SPAWN_CHUNK ? num - start : SPAWN_CHUNK;
+        rng_fill_floats(&state->rng, xs, count, 0, SCREEN_WIDTH);
+        rng_fill_floats(&state->rng, ys, count, 0, SCREEN_HEIGHT);
+        for (int i = 0; i < count; i++) {
+            queue_asteroid(state, LARGE, create_vector(xs[i], ys[i]));
+        }
+    }
+}
+
+// Adds at most budget queued asteroids, oldest first, and returns how many
+int drain_spawns(State* state, int budget) {
+    SpawnQueue* queue = &state->spawns;
+    int count = queue->count < budget ? queue->count : budget;
+    if (count <= 0) {
+        return 0;
+    }
+    if (!grow_asteroids(&state->asteroids, state->asteroids.count + count)) {
+        fprintf(stderr, "Failed to allocate queued asteroids!\n");
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const SpawnRequest* request = &queue->items[queue->head + i];
+        add_asteroid(state, request->size, request->position, request->seed);
+    }
+    queue->head += count;
+    queue->count -= count;
+    if (queue->count == 0) {
+        queue->head = 0;
+    }
+    return count;
+}
+
+int asteroid_size_idx(AsteroidSize size) {
+    switch (size) {
+    case SMALL:
+        return 0;
+        break;
+    case MEDIUM:
+        return 1;
+        break;
+    case LARGE:
+        return 2;
+        break;
+    default:
+        break;
+    }
+    return -1;
+}
+
+int fire_projectile(ProjectileArray* projectiles, Vector2 position,
+                    float angle, Uint32 time) {
+    float dX = cos(angle) * PROJ_SPEED;
+    float dY = sin(angle) * PROJ_SPEED;
+    Vector2 velocity = create_vector(-dX, -dY);
+    return push_projectile(projectiles, position, velocity, time);
+}
+
+void add_projectile(State* state, Uint32 time) {
+    Player* player = state->player;
+    fire_projectile(&state->projectiles, player->position, player->rotation,
+                    time);
+}
+
+void update_projectiles(ProjectileArray* projectiles, float deltaTime,
+                        JobSystem* jobs) {
+    MoveJob job = {projectiles->x, projectiles->y, projectiles->vx,
+                   projectiles->vy, deltaTime, 0};
+    run_jobs(jobs, move_job, &job, projectiles->count, MOVE_CHUNK);
+}
+
+void player_shoot(State* state, Uint32 time) {
+    add_projectile(state, time);
+    queue_sound(state->sounds, SOUND_SHOOT);
+}
+
+void expire_projectiles(ProjectileArray* projectiles, Uint32 time) {
+    int i = 0;
+    while (i < projectiles->count) {
+        if ((time - projectiles->spawnTime[i]) >= PROJ_TIME) {
+            remove_projectile(projectiles, i);
+        } else {
+            i++; // Only move forward if no deletion occurs
+        }
+    }
+}
+
+void delete_projectiles(State* state, Uint32 time) {
+    expire_projectiles(&state->projectiles, time);
+    expire_projectiles(&state->alienProjs, time);
+}
+
+void update_shoot(State* state, Time* time) {
+    if (state->player->shoot &&
+        (time->time - state->player->lastShot) > FIRE_RATE) {
+        state->player->lastShot = time->time;
+        player_shoot(state, time->time);
+
+        float dX =
+            cos(state->player->rotation) * PLAYER_SHOOT_FORCE * time->deltaTime;
+        float dY =
+            sin(state->player->rotation) * PLAYER_SHOOT_FORCE * time->deltaTime;
+        Vector2 delta = create_vector(dX, dY);
+        state->player->velocity = vector_sum(state->player->velocity, delta);
+
+    } else {
+        state->player->shoot = 0;
+    }
+}
+
+// The path a shot swept this tick, from (x - dx, y - dy) to (x, y). Shots
+// never wrap, so the step is taken as it is however long the tick was.
+static Sweep shot_sweep(const ProjectileArray* shots, int idx) {
+    Sweep sweep;
+    sweep.x = shots->x[idx];
+    sweep.y = shots->y[idx];
+    sweep.dx = shots->x[idx] - shots->px[idx];
+    sweep.dy = shots->y[idx] - shots->py[idx];
+    return sweep;
+}
+
+// Fraction of the way along the sweep where it first touches the circle,
+// or -1 if it misses. Solves |start + t * d - centre| = radius for the
+// smaller root, so a fast shot cannot step over a thin target. Shots do
+// not wrap, so the start is measured to the centre directly and a shot
+// off the screen never reaches a target on it.
+static float sweep_circle(Sweep sweep, float cx, float cy, float radius) {
+    float fX = sweep.x - sweep.dx - cx;
+    float fY = sweep.y - sweep.dy - cy;
+    float c = fX * fX + fY * fY - radius * radius;
+    if (c <= 0) {
+        return 0; // started inside
+    }
+    float a = sweep.dx * sweep.dx + sweep.dy * sweep.dy;
+    float b = fX * sweep.dx + fY * sweep.dy;
+    if (a <= 0 || b >= 0) {
+        return -1; // still, or moving away
+    }
+    float disc = b * b - a * c;
+    if (disc < 0) {
+        return -1;
+    }
+    float t = (-b - sqrtf(disc)) / a;
+    return t <= 1 ? t : -1;
+}
+
+// As sweep_circle() against the outline itself, with the start given
+// relative to the asteroid centre. Every edge is worked out before any is
+// looked at, so the edge loop vectorises over the lanes of the shape with
+// no branches, and the padding edges simply never hit.
+static float sweep_polygon(const AsteroidShape* shape, float startX,
+                           float startY, float dx, float dy) {
+    float entry[ASTEROID_LANES];
+    int crossings = 0;
+    for (int i = 0; i < ASTEROID_LANES; i++) {
+        float aX = shape->x[i] - startX;
+        float aY = shape->y[i] - startY;
+        float eX = shape->x[i + 1] - shape->x[i];
+        float eY = shape->y[i + 1] - shape->y[i];
+
+        // Even-odd rule: edges crossing the ray from the start along +x
+        int straddles = (aY > 0) != (aY + eY > 0);
+        crossings += straddles & (aX - eX * aY / eY > 0);
+
+        // start + t * d meets the edge at a + u * e, parallel edges give
+        // an infinity or NaN that fails every comparison
+        float denom = dx * eY - dy * eX;
+        float t = (aX * eY - aY * eX) / denom;
+        float u = (aX * dy - aY * dx) / denom;
+        int hit = (t >= 0) & (t <= 1) & (u >= 0) & (u <= 1);
+        entry[i] = hit ? t : 2;
+    }
+    if (crossings & 1) {
+        return 0; // started inside
+    }
+
+    float first = 2;
+    for (int i = 0; i < ASTEROID_LANES; i++) {
+        first = entry[i] < first ? entry[i] : first;
+    }
+    return first <= 1 ? first : -1;
+}
+
+// Sweeps against one asteroid where it ended the tick, asteroids move far
+// less per tick than shots. A still sweep is a point inside test. The
+// bounding circle rejects most pairs before the outline is read.
+// Counts into tests rather than state->pairTests so worker threads can
+// each keep their own total
+static float asteroid_sweep(const State* state, int idx, Sweep sweep,
+                            Uint64* tests) {
+    if (grid_is_removed(&state->asteroidGrid, idx)) {
+        return -1;
+    }
+    (*tests)++;
+    const AsteroidArray* asteroids = &state->asteroids;
+    float x = asteroids->x[idx];
+    float y = asteroids->y[idx];
+    if (sweep_circle(sweep, x, y, asteroids->size[idx] * MAX_RADIUS) < 0) {
+        return -1;
+    }
+    float startX = sweep.x - sweep.dx - x;
+    float startY = sweep.y - sweep.dy - y;
+    return sweep_polygon(&asteroids->shape[idx], startX, startY, sweep.dx,
+                         sweep.dy);
+}
+
+// Returns the asteroid the sweep reaches first, the lowest index on a tie,
+// or -1. The query circle covers the whole path around its midpoint.
+static int find_asteroid(const State* state, Sweep sweep, Uint64* tests) {
+    float halfX = sweep.dx / 2;
+    float halfY = sweep.dy / 2;
+    float reach = sqrtf(halfX * halfX + halfY * halfY);
+    GridQuery query;
+    grid_query(&query, &state->asteroidGrid, sweep.x - halfX,
+               sweep.y - halfY, LARGE * MAX_RADIUS + reach,
+               state->asteroids.count);
+    int hit = -1;
+    float first = 0;
+    int idx;
+    while ((idx = grid_query_next(&query)) >= 0) {
+        float t = asteroid_sweep(state, idx, sweep, tests);
+        if (t >= 0 &&
+            (hit < 0 || t < first || (t == first && idx < hit))) {
+            hit = idx;
+            first = t;
+        }
+    }
+    return hit;
+}
+
+static void crash_job(void* data, int begin, int end, int thread) {
+    CrashJob* job = (CrashJob*)data;
+    const ProjectileArray* shots = job->shots;
+    int hits = 0;
+    for (int i = begin; i < end; i++) {
+        Sweep sweep = shot_sweep(shots, i);
+        hits += sweep_circle(sweep, job->target.x, job->target.y,
+                             job->radius) >= 0;
+    }
+    job->hits[thread] += hits;
+}
+
+void detect_crash(State* state, Uint32 time) {
+    Vector2 position = state->player->position;
+    Sweep still = {position.x, position.y, 0, 0};
+    GridQuery query;
+    grid_query(&query, &state->asteroidGrid, position.x, position.y,
+               LARGE * MAX_RADIUS, state->asteroids.count);
+    int i;
+    while ((i = grid_query_next(&query)) >= 0) {
+        if (asteroid_sweep(state, i, still, &state->pairTests) >= 0) {
+            state->player->crashed = 1;
+            state->player->crashTime = time;
+            on_crash(state);
+            queue_sound(state->sounds, SOUND_EXPLOSION);
+        }
+    }
+
+    // Only the number of hits matters, each one crashes the ship again
+    CrashJob job;
+    memset(&job, 0, sizeof(job));
+    job.shots = &state->alienProjs;
+    job.target = position;
+    job.radius = PLAYER_SIZE;
+    run_jobs(state->jobs, crash_job, &job, state->alienProjs.count,
+             CRASH_CHUNK);
+    state->pairTests += state->alienProjs.count;
+
+    int hits = 0;
+    for (int i = 0; i < job_threads(state->jobs); i++) {
+        hits += job.hits[i];
+    }
+    for (int i = 0; i < hits; i++) {
+        state->player->crashed = 1;
+        state->player->crashTime = time;
+        on_crash(state);
+        queue_sound(state->sounds, SOUND_EXPLOSION);
+    }
+}
+
+void respawn(Player* player) {
+    player->position = create_vector(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f);
+    player->crashed = 0;
+}
+
+static int reserve_shot_hits(State* state, int count) {
+    if (count <= state->shotCapacity) {
+        return 1;
+    }
+    int capacity = state->shotCapacity * 2;
+    if (capacity < count) {
+        capacity = count;
+    }
+    int* hits = (int*)realloc(state->shotHits, sizeof(int) * capacity);
+    if (!hits) {
+        return 0;
+    }
+    state->shotHits = hits;
+    state->shotCapacity = capacity;
+    return 1;
+}
+
+static void shot_job(void* data, int begin, int end, int thread) {
+    ShotJob* job = (ShotJob*)data;
+    const ProjectileArray* projectiles = &job->state->projectiles;
+    Uint64 tests = 0;
+    float reach = job->reach[thread];
+    for (int i = begin; i < end; i++) {
+        Sweep sweep = shot_sweep(projectiles, i);
+        float step = sweep.dx * sweep.dx + sweep.dy * sweep.dy;
+        reach = step > reach ? step : reach;
+        job->hits[i] = find_asteroid(job->state, sweep, &tests);
+    }
+    job->tests[thread] += tests;
+    job->reach[thread] = reach;
+}
+
+void detect_Shoot(State* state) {
+    AsteroidArray* asteroids = &state->asteroids;
+    ProjectileArray* projectiles = &state->projectiles;
+    Grid* grid = &state->asteroidGrid;
+    // One query per projectile plus the player in detect_crash()
+    int numQueries = projectiles->count + 1;
+    prepare_grid(grid, asteroids->x, asteroids->y, asteroids->count,
+                 numQueries);
+
+    // Every shot could destroy and split an asteroid, so the destroyed list
+    // and the fragments queued below never grow inside the loop
+    int numShots = projectiles->count;
+    if (!reserve_shot_hits(state, numShots) ||
+        !reserve_handle_list(&state->destroyed, numShots) ||
+        !reserve_spawns(&state->spawns, numShots * BROKEN_ASTEROID_NUM)) {
+        fprintf(stderr, "Failed to allocate shot results!\n");
+        return;
+    }
+
+    // The queries only read the state, so they run in parallel
+    ShotJob job;
+    memset(&job, 0, sizeof(job));
+    job.state = state;
+    job.hits = state->shotHits;
+    run_jobs(state->jobs, shot_job, &job, numShots, SHOT_CHUNK);
+    float reach = 0;
+    for (int i = 0; i < job_threads(state->jobs); i++) {
+        state->pairTests += job.tests[i];
+        reach = job.reach[i] > reach ? job.reach[i] : reach;
+    }
+
+    // Side effects are applied here in projectile order, so the outcome is
+    // the same whatever the number of threads. Fragments wait in the spawn
+    // queue, so no shot can hit one in the tick it was made.
+    HandleList* destroyed = &state->destroyed;
+    destroyed->count = 0;
+    for (int i = 0; i < numShots; i++) {
+        int j = state->shotHits[i];
+        // Query again if that asteroid was destroyed by an earlier shot
+        if (j >= 0 && grid_is_removed(grid, j)) {
+            j = find_asteroid(state, shot_sweep(projectiles, i),
+                              &state->pairTests);
+            state->shotHits[i] = j;
+        }
+        if (j < 0) {
+            continue;
+        }
+
+        // Removal is deferred so the indices in the grid stay valid, the
+        // handle follows the asteroid through any swaps made before then.
+        // The list was reserved above, the check only keeps a failure from
+        // scoring an asteroid that would never be removed.
+        if (!push_handle(destroyed, asteroid_handle(asteroids, j))) {
+            state->shotHits[i] = -1; // the shot carries on
+            continue;
+        }
+        grid_mark_removed(grid, j);
+
+        queue_sound(state->sounds, SOUND_HIT);
+        AsteroidSize size = asteroids->size[j];
+        Vector2 position = create_vector(asteroids->x[j], asteroids->y[j]);
+        on_destroy(state, size, position);
+    }
+
+    // Backwards, so each swap brings in a shot that is staying
+    for (int i = numShots - 1; i >= 0; i--) {
+        if (state->shotHits[i] >= 0) {
+            remove_projectile(projectiles, i);
+        }
+    }
+
+    if (destroyed->count > 0) {
+        for (int i = 0; i < destroyed->count; i++) {
+            int j = resolve_asteroid(asteroids, destroyed->items[i]);
+            if (j >= 0) {
+                remove_asteroid(asteroids, j);
+            }
+        }
+        prepare_grid(grid, asteroids->x, asteroids->y, asteroids->count,
+                     numQueries);
+    }
+
+    // Backwards, so removing an alien only swaps in one already tested.
+    // Each takes the lowest indexed shot that swept into it and is still
+    // free, and the shots go once every alien has been tested.
+    AlienArray* aliens = &state->aliens;
+    if (aliens->count > 0 && projectiles->count > 0) {
+        Grid* projGrid = &state->projectileGrid;
+        prepare_grid(projGrid, projectiles->x, projectiles->y,
+                     projectiles->count, aliens->count);
+        int* taken = state->shotHits; // free again, and large enough
+        memset(taken, 0, sizeof(int) * projectiles->count);
+
+        int numTaken = 0;
+        for (int a = aliens->count - 1; a >= 0; a--) {
+            // The grid holds where each shot ended, so reach out by the
+            // longest step to catch any that swept through the alien
+            GridQuery query;
+            grid_query(&query, projGrid, aliens->x[a], aliens->y[a],
+                       ALIEN_SIZE + sqrtf(reach), projectiles->count);
+            int hit = -1;
+            int i;
+            while ((i = grid_query_next(&query)) >= 0) {
+                Sweep sweep = shot_sweep(projectiles, i);
+                state->pairTests++;
+                if (!taken[i] && (hit < 0 || i < hit) &&
+                    sweep_circle(sweep, aliens->x[a], aliens->y[a],
+                                 ALIEN_SIZE) >= 0) {
+                    hit = i;
+                }
+            }
+
+            if (hit >= 0) {
+                queue_sound(state->sounds, SOUND_RAN);
+                Vector2 position = create_vector(aliens->x[a], aliens->y[a]);
+                Vector2 still = create_vector(0, 0);
+                emit_particles(&state->particles, &ALIEN_SPARKS, position,
+                               still, &state->fxRng);
+                emit_particles(&state->particles, &ALIEN_DEBRIS, position,
+                               still, &state->fxRng);
+                taken[hit] = 1;
+                numTaken++;
+                remove_alien(aliens, a);
+            }
+        }
+
+        for (int i = projectiles->count - 1; numTaken > 0 && i >= 0; i--) {
+            if (taken[i]) {
+                remove_projectile(projectiles, i);
+                numTaken--;
+            }
+        }
+    }
+}
+
+void on_destroy(State* state, AsteroidSize size, Vector2 position) {
+    int idx = asteroid_size_idx(size);
+    if (idx < 0) {
+        return;
+    }
+    state->score += (int)SCORES[idx];
+    emit_particles(&state->particles, &ASTEROID_DUST, position,
+                   create_vector(0, 0), &state->fxRng);
+    if (size == MEDIUM) {
+        for (int i = 0; i < BROKEN_ASTEROID_NUM; i++) {
+            queue_asteroid(state, SMALL, position);
+        }
+    } else if (size == LARGE) {
+        for (int i = 0; i < BROKEN_ASTEROID_NUM; i++) {
+            queue_asteroid(state, MEDIUM, position);
+        }
+    }
+}
+
+void on_crash(State* state) {
+    Player* player = state->player;
+    emit_particles(&state->particles, &CRASH_SPARKS, player->position,
+                   player->velocity, &state->fxRng);
+    emit_particles(&state->particles, &CRASH_DEBRIS, player->position,
+                   player->velocity, &state->fxRng);
+    player->velocity = create_vector(0, 0);
+}
+
+// One alien from level two, and another every ALIEN_LEVEL_STEP levels
+int aliens_for_level(int level) {
+    if (level < 2) {
+        return 0;
+    }
+    return 1 + (level - 2) / ALIEN_LEVEL_STEP;
+}
+
+// Aliens enter in a line from the left. Their first shots are spread over
+// one fire period so a large wave never fires in a single tick.
+void spawn_aliens(State* state, int num, Uint32 time) {
+    for (int i = 0; i < num; i++) {
+        Vector2 position = create_vector(-i * ALIEN_SPACING, 100);
+        Uint32 delay = (Uint32)((Uint64)ALIEN_FIRE_RATE * i / num);
+        if (push_alien(&state->aliens, position, time + delay) < 0) {
+            fprintf(stderr, "Failed to allocate aliens!\n");
+            return;
+        }
+    }
+}
+
+// Time until a shot fired now meets a target at offset (dX, dY) moving at
+// velocity, the positive root of |d + v * t| = PROJ_SPEED * t. Zero when
+// the target outruns the shots, which then aim where it is.
+static float intercept_time(float dX, float dY, Vector2 velocity) {
+    float a = velocity.x * velocity.x + velocity.y * velocity.y -
+              PROJ_SPEED * PROJ_SPEED;
+    if (a >= 0) {
+        return 0;
+    }
+    float b = dX * velocity.x + dY * velocity.y;
+    float c = dX * dX + dY * dY;
+    return (-b - sqrtf(b * b - a * c)) / a;
+}
+
+// Steers, aims and fires every alien in one pass. Each closes in on the
+// ship until ALIEN_STANDOFF away and leads its aim by the ship's velocity.
+void update_aliens(State* state, Time* time) {
+    AlienArray* aliens = &state->aliens;
+    const Player* player = state->player;
+    Vector2 target = player->position;
+    float step = ALIEN_SPEED * time->deltaTime;
+    int canFire = !player->crashed &&
+                  (time->time - player->crashTime) >=
+                      RESPAWN_TIME + PLAYER_SAFE_TIME;
+
+    for (int i = 0; i < aliens->count; i++) {
+        float dX = target.x - aliens->x[i];
+        float dY = target.y - aliens->y[i];
+        float distance = sqrtf(dX * dX + dY * dY);
+        if (distance > ALIEN_STANDOFF) {
+            float move = fminf(step, distance - ALIEN_STANDOFF) / distance;
+            aliens->x[i] += dX * move;
+            aliens->y[i] += dY * move;
+            dX = target.x - aliens->x[i];
+            dY = target.y - aliens->y[i];
+        }
+
+        float lead = intercept_time(dX, dY, player->velocity);
+        float aimX = dX + player->velocity.x * lead;
+        float aimY = dY + player->velocity.y * lead;
+        // Shots travel against the angle, see fire_projectile()
+        aliens->rotation[i] = atan2f(-aimY, -aimX);
+
+        if (canFire && time->time >= aliens->nextShot[i]) {
+            aliens->nextShot[i] = time->time + ALIEN_FIRE_RATE;
+            Vector2 position = create_vector(aliens->x[i], aliens->y[i]);
+            fire_projectile(&state->alienProjs, position,
+                            aliens->rotation[i], time->time);
+        }
+    }
+}
@@ -0,0 +1,213 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "entity.h"
+#include "grid.h"
+#include "integrate.h"
+#include "jobs.h"
+#include "particles.h"
+#include "profile.h"
+#include "rng.h"
+#include "sound.h"
+#include "vec.h"
+#include <SDL2/SDL_stdinc.h>
+#include <math.h>
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+// Screen dimensions
+static const int SCREEN_WIDTH = 1000;
+static const int SCREEN_HEIGHT = 800;
+
+// Time constants
+static const float MS_TO_SECONDS_F = 1000.0f;
+static const Uint32 MS_TO_SECONDS = 1000;
+
+static const float PLAYER_SPEED = 2000.0f;
+static const float PLAYER_SHOOT_FORCE = 30.0f;
+static const float PLAYER_ROTATION_RATE = 5.5f;
+static const float PLAYER_DRAG = 3.00f;
+static const float VERTICLE = M_PI / 2;
+
+static const float MIN_RADIUS = 2.0f;
+static const float MAX_RADIUS = 4.0f;
+
+static const int INIT_CAPACITY = 20;
+static const int INIT_NUM_ASTEROIDS = 5;
+#define SPAWN_CHUNK 64 // asteroid positions drawn per batch fill
+
+// Queued asteroids added per tick. Each one builds an outline, so this
+// bounds the cost of a level transition whatever the level number.
+static const int SPAWN_BUDGET = 32;
+
+// Items per parallel job, small enough to spread a few thousand entities
+// over the workers and large enough that claiming a chunk is noise
+static const int MOVE_CHUNK = 2048;
+static const int SHOT_CHUNK = 128;
+static const int CRASH_CHUNK = 4096;
+
+static const float PROJ_SPEED = 1000.0f;
+static const Uint32 PROJ_TIME = 10000;
+static const int BROKEN_ASTEROID_NUM = 2;
+
+static const Uint32 RESPAWN_TIME = 2000;
+static const Uint32 FIRE_RATE = 150;
+
+// Cosmetic bursts: count, speed range, share of the source's velocity,
+// debris line length (0 for dots) and lifetime in seconds. The crash
+// lasts until the respawn.
+static const Emitter CRASH_SPARKS = {30, 20.0f, 80.0f, 0.4f, 0, 2.0f};
+static const Emitter CRASH_DEBRIS = {4, 20.0f, 80.0f, 0.4f, 20.0f, 2.0f};
+static const Emitter ASTEROID_DUST = {12, 30.0f, 120.0f, 0, 0, 0.8f};
+static const Emitter ALIEN_SPARKS = {24, 40.0f, 160.0f, 0, 0, 1.0f};
+static const Emitter ALIEN_DEBRIS = {6, 20.0f, 60.0f, 0, 10.0f, 1.5f};
+
+static const float ALIEN_SPEED = 150.0f;
+static const Uint32 ALIEN_FIRE_RATE = 1000;
+static const float ALIEN_STANDOFF = 200.0f; // distance kept from the ship
+static const float ALIEN_SPACING = 60.0f;   // between aliens entering
+static const int ALIEN_LEVEL_STEP = 4;      // levels per extra alien
+static const float PLAYER_SIZE = 15.0f;
+static const float ALIEN_SIZE = 25.0f;
+static const Uint32 PLAYER_SAFE_TIME = 1000;
+
+/*------------------------------------ENUMS-----------------------------------*/
+typedef enum {
+    OK,
+    WINDOW_ERROR,
+    GAME_ERROR,
+} ExitStatus;
+
+typedef enum {
+    SMALL_POINTS = 8,
+    MEDIUM_POINTS = 10,
+    LARGE_POINTS = 13,
+} AsteroidPoints;
+
+typedef enum {
+    SMALL_SCORE = 100,
+    MEDIUM_SCORE = 50,
+    LARGE_SCORE = 20,
+} AsteroidScores;
+
+// Input bits sampled once per update, see handle_events()
+typedef enum {
+    INPUT_THRUST = 1 << 0,
+    INPUT_LEFT = 1 << 1,
+    INPUT_RIGHT = 1 << 2,
+    INPUT_SHOOT = 1 << 3,
+} InputFlags;
+
+static const AsteroidScores SCORES[] = {SMALL_SCORE, MEDIUM_SCORE,
+                                        LARGE_SCORE};
+static const AsteroidPoints ASTEROID_POINTS[] = {SMALL_POINTS, MEDIUM_POINTS,
+                                                 LARGE_POINTS};
+
+static const AsteroidSize ASTEROID_SIZES[] = {SMALL, MEDIUM, LARGE};
+static const float MIN_ASTEROID_SPEEDS[] = {100.0f, 40.0f, 20.0f};
+static const float MAX_ASTEROID_SPEEDS[] = {200.0f, 80.0f, 30.0f};
+
+/*-----------------------------------STRUCTS----------------------------------*/
+typedef struct {
+    float deltaTime;
+    Uint32 time;
+    Uint32 lastSecond;
+    Uint32 lastFrame;
+    int frames;
+    int fps;
+} Time;
+
+typedef struct {
+    int moving;
+    int shoot;
+    int crashed;
+    Vector2 position;
+    Vector2 velocity;
+    float rotation;
+    Vector2 prevPosition; // pose at the start of the tick, for rendering
+    float prevRotation;
+    Uint32 lastShot;
+    Uint32 crashTime;
+} Player;
+
+// An asteroid waiting in the spawn queue. The position and outline seed are
+// drawn when it is queued, its velocity when it is added.
+typedef struct {
+    AsteroidSize size;
+    Vector2 position;
+    Uint32 seed;
+} SpawnRequest;
+
+// First in, first out. Live requests are items[head, head + count).
+typedef struct {
+    int head;
+    int count;
+    int capacity;
+    SpawnRequest* items;
+} SpawnQueue;
+
+typedef struct {
+    int score;
+    int level;
+    Player* player;
+    AlienArray aliens;
+    AsteroidArray asteroids;
+    SpawnQueue spawns; // new levels and fragments, see drain_spawns()
+    ProjectileArray projectiles;
+    ProjectileArray alienProjs;
+    Grid asteroidGrid;    // broadphase for point queries against asteroids
+    Grid projectileGrid;  // broadphase for circle queries against shots
+    Uint64 pairTests;     // narrowphase distance tests since init_state()
+    HandleList destroyed; // asteroids hit this update, removed afterwards
+    int* shotHits;        // asteroid found by each projectile, or -1
+    int shotCapacity;
+    ParticleSystem particles; // cosmetic, driven by fxRng
+    Rng rng;              // gameplay randomness, see seed_state()
+    Rng fxRng;            // cosmetic randomness that must never affect gameplay
+    SoundManager* sounds; // NULL when running without audio
+    Profiler* profiler;   // NULL unless profiling, owned by the caller
+    JobSystem* jobs;      // NULL runs every phase here, owned by the caller
+} State;
+
+/*----------------------------------PROTOTYPES--------------------------------*/
+void update_state(State* state, Uint8 input, Time* gameTime);
+Uint32 tick_time(Uint64 tick, float deltaTime);
+void save_previous(State* state);
+void apply_input(Player* player, Uint8 input, float deltaTime);
+Player* init_ship(const float x, const float y);
+State* init_state(void);
+void free_player(Player* player);
+void free_state(State* state);
+void update_player(Player* player, float deltaTime);
+void seed_state(State* state, Uint64 seed);
+int add_asteroid(State* state, AsteroidSize size, Vector2 position,
+                 Uint32 seed);
+void build_asteroid_shape(AsteroidShape* shape, AsteroidSize size,
+                          Uint32 seed);
+void update_asteroids(AsteroidArray* asteroids, float deltaTime,
+                      JobSystem* jobs);
+void spawn_asteroids(State* state, int num);
+void queue_asteroid(State* state, AsteroidSize size, Vector2 position);
+void queue_asteroids(State* state, int num);
+int drain_spawns(State* state, int budget);
+int resize_spawns(SpawnQueue* queue, int count);
+int asteroid_size_idx(AsteroidSize size);
+int fire_projectile(ProjectileArray* projectiles, Vector2 position,
+                    float angle, Uint32 time);
+void add_projectile(State* state, Uint32 time);
+void update_projectiles(ProjectileArray* projectiles, float deltaTime,
+                        JobSystem* jobs);
+void expire_projectiles(ProjectileArray* projectiles, Uint32 time);
+void delete_projectiles(State* state, Uint32 time);
+void update_shoot(State* state, Time* time);
+void detect_crash(State* state, Uint32 time);
+void detect_Shoot(State* state);
+void on_destroy(State* state, AsteroidSize size, Vector2 position);
+void on_crash(State* state);
+void respawn(Player* player);
+void player_shoot(State* state, Uint32 time);
+int aliens_for_level(int level);
+void spawn_aliens(State* state, int num, Uint32 time);
+void update_aliens(State* state, Time* time);
+
+#endif
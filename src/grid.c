@@ -0,0 +1,207 @@
+#include "grid.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+int init_grid(Grid* grid, int width, int height, float cellSize) {
+    grid->cellSize = cellSize;
+    grid->invCellSize = 1.0f / cellSize;
+    grid->cols = (int)ceilf(width / cellSize);
+    grid->rows = (int)ceilf(height / cellSize);
+    grid->itemCount = 0;
+    grid->itemCapacity = 0;
+    grid->markCapacity = 0;
+    grid->numRemoved = 0;
+    grid->itemCell = NULL;
+    grid->entries = NULL;
+    grid->removed = NULL;
+
+    int numCells = grid->cols * grid->rows;
+    grid->cellStart = (int*)calloc(numCells + 1, sizeof(int));
+    grid->cursor = (int*)malloc(sizeof(int) * numCells);
+    if (!grid->cellStart || !grid->cursor) {
+        free_grid(grid);
+        return 0;
+    }
+    return 1;
+}
+
+void free_grid(Grid* grid) {
+    free(grid->cellStart);
+    free(grid->cursor);
+    free(grid->itemCell);
+    free(grid->entries);
+    free(grid->removed);
+    grid->cellStart = NULL;
+    grid->cursor = NULL;
+    grid->itemCell = NULL;
+    grid->entries = NULL;
+    grid->removed = NULL;
+}
+
+// Positive modulo so coordinates off either edge wrap onto the grid. Most
+// coordinates are already on screen, so skip the division for those.
+static int wrap_cell(int cell, int size) {
+    if ((unsigned)cell < (unsigned)size) {
+        return cell;
+    }
+    cell %= size;
+    return cell < 0 ? cell + size : cell;
+}
+
+static int cell_coord(const Grid* grid, float position) {
+    return (int)floorf(position * grid->invCellSize);
+}
+
+int grid_cell(const Grid* grid, float x, float y) {
+    int cx = wrap_cell(cell_coord(grid, x), grid->cols);
+    int cy = wrap_cell(cell_coord(grid, y), grid->rows);
+    return cy * grid->cols + cx;
+}
+
+int grid_cells_in_radius(const Grid* grid, float x, float y, float radius,
+                         int cells[GRID_MAX_QUERY_CELLS]) {
+    int x0 = cell_coord(grid, x - radius);
+    int x1 = cell_coord(grid, x + radius);
+    int y0 = cell_coord(grid, y - radius);
+    int y1 = cell_coord(grid, y + radius);
+
+    // Never visit a wrapped cell twice on very small grids
+    if (x1 - x0 >= grid->cols) {
+        x1 = x0 + grid->cols - 1;
+    }
+    if (y1 - y0 >= grid->rows) {
+        y1 = y0 + grid->rows - 1;
+    }
+
+    // Wrap the first cell once, then step and wrap by hand
+    int startX = wrap_cell(x0, grid->cols);
+    int row = wrap_cell(y0, grid->rows);
+    int count = 0;
+    for (int cy = y0; cy <= y1; cy++) {
+        int col = startX;
+        for (int cx = x0; cx <= x1; cx++) {
+            cells[count++] = row * grid->cols + col;
+            if (++col == grid->cols) {
+                col = 0;
+            }
+        }
+        if (++row == grid->rows) {
+            row = 0;
+        }
+    }
+    return count;
+}
+
+static int reserve_items(Grid* grid, int capacity) {
+    if (capacity <= grid->itemCapacity) {
+        return 1;
+    }
+    int* itemCell = (int*)realloc(grid->itemCell, sizeof(int) * capacity);
+    if (!itemCell) {
+        return 0;
+    }
+    grid->itemCell = itemCell;
+
+    int* entries = (int*)realloc(grid->entries, sizeof(int) * capacity);
+    if (!entries) {
+        return 0;
+    }
+    grid->entries = entries;
+    grid->itemCapacity = capacity;
+    return 1;
+}
+
+static int reserve_marks(Grid* grid, int capacity) {
+    if (capacity <= grid->markCapacity) {
+        return 1;
+    }
+    int newCapacity = grid->markCapacity * 2;
+    if (newCapacity < capacity) {
+        newCapacity = capacity;
+    }
+    Uint8* removed = (Uint8*)realloc(grid->removed, newCapacity);
+    if (!removed) {
+        return 0;
+    }
+    memset(removed + grid->markCapacity, 0,
+           newCapacity - grid->markCapacity);
+    grid->removed = removed;
+    grid->markCapacity = newCapacity;
+    return 1;
+}
+
+// Counting sort over cells: count, prefix sum, then scatter. Items past
+// itemCount (added after the build) are not in any cell.
+int build_grid(Grid* grid, const float* x, const float* y, int count) {
+    int numCells = grid->cols * grid->rows;
+    memset(grid->cellStart, 0, sizeof(int) * (numCells + 1));
+    if (grid->numRemoved > 0) {
+        memset(grid->removed, 0, grid->markCapacity);
+        grid->numRemoved = 0;
+    }
+    if (!reserve_items(grid, count) || !reserve_marks(grid, count)) {
+        grid->itemCount = 0;
+        return 0;
+    }
+    grid->itemCount = count;
+
+    for (int i = 0; i < count; i++) {
+        int cell = grid_cell(grid, x[i], y[i]);
+        grid->itemCell[i] = cell;
+        grid->cellStart[cell]++;
+    }
+
+    int total = 0;
+    for (int cell = 0; cell < numCells; cell++) {
+        int cellCount = grid->cellStart[cell];
+        grid->cellStart[cell] = total;
+        grid->cursor[cell] = total;
+        total += cellCount;
+    }
+    grid->cellStart[numCells] = total;
+
+    for (int i = 0; i < count; i++) {
+        grid->entries[grid->cursor[grid->itemCell[i]]++] = i;
+    }
+    return 1;
+}
+
+int prepare_grid(Grid* grid, const float* x, const float* y, int count,
+                 int numQueries) {
+    if (numQueries < GRID_MIN_QUERIES) {
+        count = 0;
+        // Already empty, so there is nothing to clear
+        if (grid->itemCount == 0 && grid->numRemoved == 0) {
+            return 1;
+        }
+    }
+    return build_grid(grid, x, y, count);
+}
+
+void grid_query(GridQuery* query, const Grid* grid, float x, float y,
+                float radius, int totalItems) {
+    query->grid = grid;
+    query->numCells = 0;
+    query->tail = grid->itemCount;
+    if (radius > grid->cellSize * GRID_MAX_QUERY_REACH) {
+        query->tail = 0; // too wide for the cell list, scan everything
+    } else if (grid->itemCount > 0) {
+        query->numCells = grid_cells_in_radius(grid, x, y, radius,
+                                               query->cells);
+    }
+    query->cell = 0;
+    query->items = NULL;
+    query->count = 0;
+    query->next = 0;
+    query->tailEnd = totalItems;
+}
+
+int grid_mark_removed(Grid* grid, int item) {
+    if (!reserve_marks(grid, item + 1)) {
+        return 0;
+    }
+    grid->removed[item] = 1;
+    grid->numRemoved++;
+    return 1;
+}
@@ -0,0 +1,99 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <SDL2/SDL_stdinc.h>
+
+// Divides both screen dimensions so the grid wraps exactly at the edges,
+// and is at least as large as the biggest asteroid radius (LARGE * 4)
+static const float GRID_CELL_SIZE = 50.0f;
+// Queries reach at most this many cells from their centre cell, enough
+// for the largest asteroid plus a shot's step at low tick rates
+#define GRID_MAX_QUERY_REACH 2
+#define GRID_MAX_QUERY_CELLS 25 // (2 * reach + 1) squared
+// Building costs a pass over the items and cells, so below this many
+// queries per build a linear scan is cheaper
+static const int GRID_MIN_QUERIES = 8;
+
+// Uniform grid over the toroidal playfield, rebuilt from scratch each tick.
+// Every item is bucketed by the cell holding its centre with a counting
+// sort, so each cell's items are contiguous and in ascending index order.
+// Queries visit every cell within the combined radius of the query and the
+// largest item, which is 3x3 cells while both fit in one cell and up to
+// 5x5 for a swept shot. Anything wider scans every item instead.
+typedef struct {
+    int cols;
+    int rows;
+    float cellSize;
+    float invCellSize;
+    int itemCount; // number of items the grid was last built from
+    int itemCapacity;
+    int markCapacity;
+    int numRemoved;
+    int* cellStart; // cols * rows + 1 offsets into entries
+    int* cursor;    // per-cell fill position used while building
+    int* itemCell;  // cell of each item, cached between build passes
+    int* entries;
+    Uint8* removed; // items removed since the last build
+} Grid;
+
+// Walks the candidates for one query: items in the cells the query circle
+// reaches, then every item added since the build (all items when the grid
+// was built empty, which makes the query a plain linear scan)
+typedef struct {
+    const Grid* grid;
+    int cells[GRID_MAX_QUERY_CELLS];
+    int numCells;
+    int cell;
+    const int* items;
+    int count;
+    int next;
+    int tail;
+    int tailEnd;
+} GridQuery;
+
+int init_grid(Grid* grid, int width, int height, float cellSize);
+void free_grid(Grid* grid);
+int build_grid(Grid* grid, const float* x, const float* y, int count);
+// Builds only when numQueries makes it worthwhile, otherwise empties it
+int prepare_grid(Grid* grid, const float* x, const float* y, int count,
+                 int numQueries);
+
+int grid_cell(const Grid* grid, float x, float y);
+// Fills cells with the cells a circle overlaps
+// (radius <= GRID_MAX_QUERY_REACH cells)
+int grid_cells_in_radius(const Grid* grid, float x, float y, float radius,
+                         int cells[GRID_MAX_QUERY_CELLS]);
+
+// radius is the query radius plus the largest item radius
+void grid_query(GridQuery* query, const Grid* grid, float x, float y,
+                float radius, int totalItems);
+int grid_mark_removed(Grid* grid, int item);
+
+// Called once per candidate, so these live here to be inlined into the
+// collision loops
+
+static inline const int* grid_cell_items(const Grid* grid, int cell,
+                                         int* count) {
+    *count = grid->cellStart[cell + 1] - grid->cellStart[cell];
+    return grid->entries + grid->cellStart[cell];
+}
+
+// Returns the next candidate item, or -1 once the query is exhausted
+static inline int grid_query_next(GridQuery* query) {
+    while (query->next >= query->count) {
+        if (query->cell >= query->numCells) {
+            return query->tail < query->tailEnd ? query->tail++ : -1;
+        }
+        query->items = grid_cell_items(query->grid,
+                                       query->cells[query->cell++],
+                                       &query->count);
+        query->next = 0;
+    }
+    return query->items[query->next++];
+}
+
+static inline int grid_is_removed(const Grid* grid, int item) {
+    return item < grid->markCapacity && grid->removed[item];
+}
+
+#endif
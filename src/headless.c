@@ -0,0 +1,106 @@
+#include "headless.h"
+#include <SDL2/SDL_timer.h>
+#include <stdlib.h>
+
+const Uint64 DEFAULT_HEADLESS_TICKS = 100000;
+const float DEFAULT_HEADLESS_DELTA = 1.0f / 60.0f;
+
+void init_headless_config(HeadlessConfig* config) {
+    config->ticks = DEFAULT_HEADLESS_TICKS;
+    config->seed = 1;
+    config->deltaTime = DEFAULT_HEADLESS_DELTA;
+    // Spin and fire so the collision code has something to do
+    config->input = INPUT_LEFT | INPUT_SHOOT;
+    config->replay = NULL;
+    config->record = NULL;
+    config->profiler = NULL;
+    config->workers = default_workers();
+}
+
+// Nothing is drawn, so a frame is one tick and has no draw calls. Frames
+// are exported before the ring wraps so none are lost on long runs.
+static void profile_tick(const State* state, Uint64 pairTests) {
+    ProfileCounters counters;
+    counters.asteroids = state->asteroids.count;
+    counters.projectiles = state->projectiles.count + state->alienProjs.count;
+    counters.pairTests = state->pairTests - pairTests;
+    counters.drawCalls = 0;
+    end_frame(state->profiler, &counters);
+    if (state->profiler->current.frame % (PROFILE_HISTORY / 2) == 0) {
+        export_frames(state->profiler);
+    }
+}
+
+int run_headless(const HeadlessConfig* config, HeadlessStats* stats) {
+    State* state = init_state();
+    if (!state) {
+        fprintf(stderr, "Failed to initialize game state!\n");
+        return GAME_ERROR;
+    }
+
+    state->profiler = config->profiler;
+    state->jobs = init_jobs(config->workers);
+    if (!state->jobs) {
+        free_state(state);
+        return GAME_ERROR;
+    }
+    seed_state(state, config->seed);
+    spawn_asteroids(state, INIT_NUM_ASTEROIDS);
+
+    Time gameTime = {0};
+    gameTime.deltaTime = config->deltaTime;
+
+    Uint64 ticks = 0;
+    Uint64 start = SDL_GetPerformanceCounter();
+    while (config->replay || ticks < config->ticks) {
+        Uint8 input = config->input;
+        if (config->replay && !next_replay_input(config->replay, &input)) {
+            break;
+        }
+        if (config->record) {
+            record_input(config->record, input);
+        }
+
+        ticks++;
+        gameTime.time = tick_time(ticks, config->deltaTime);
+        gameTime.frames++;
+        Uint64 pairTests = state->pairTests;
+        begin_frame(state->profiler);
+        update_state(state, input, &gameTime);
+        if (state->profiler) {
+            profile_tick(state, pairTests);
+        }
+    }
+    Uint64 end = SDL_GetPerformanceCounter();
+
+    stats->ticks = ticks;
+    stats->seconds = (double)(end - start) / SDL_GetPerformanceFrequency();
+    stats->ticksPerSecond =
+        stats->seconds > 0 ? stats->ticks / stats->seconds : 0;
+    stats->workers = state->jobs->numWorkers;
+    stats->asteroids = state->asteroids.count;
+    stats->projectiles = state->projectiles.count;
+    stats->alienProjs = state->alienProjs.count;
+    stats->level = state->level;
+    stats->score = state->score;
+    stats->pairTests = state->pairTests;
+
+    free_jobs(state->jobs);
+    free_state(state);
+    return OK;
+}
+
+void print_headless_stats(FILE* out, const HeadlessStats* stats) {
+    fprintf(out, "ticks: %llu\n", (unsigned long long)stats->ticks);
+    fprintf(out, "seconds: %.3f\n", stats->seconds);
+    fprintf(out, "ticks/sec: %.0f\n", stats->ticksPerSecond);
+    fprintf(out, "workers: %d\n", stats->workers);
+    fprintf(out, "asteroids: %d\n", stats->asteroids);
+    fprintf(out, "projectiles: %d\n", stats->projectiles);
+    fprintf(out, "alien projectiles: %d\n", stats->alienProjs);
+    fprintf(out, "level: %d\n", stats->level);
+    fprintf(out, "score: %d\n", stats->score);
+    fprintf(out, "pair tests: %llu (%.1f per tick)\n",
+            (unsigned long long)stats->pairTests,
+            stats->ticks ? (double)stats->pairTests / stats->ticks : 0.0);
+}
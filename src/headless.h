@@ -0,0 +1,38 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "game.h"
+#include "profile.h"
+#include "replay.h"
+#include <stdio.h>
+
+typedef struct {
+    Uint64 ticks;         // number of update_state() calls to run
+    Uint32 seed;          // passed to seed_state() before the first spawn
+    float deltaTime;      // simulated seconds per tick
+    Uint8 input;          // InputFlags held down for the whole run
+    ReplayReader* replay; // if set, supplies the input and length of the run
+    ReplayWriter* record; // if set, receives the input of every tick
+    Profiler* profiler;   // if set, each tick is profiled as a frame
+    int workers;          // threads besides this one, 0 for none
+} HeadlessConfig;
+
+typedef struct {
+    Uint64 ticks;
+    double seconds; // wall clock time spent ticking
+    double ticksPerSecond;
+    int workers;
+    int asteroids;
+    int projectiles;
+    int alienProjs;
+    int level;
+    int score;
+    Uint64 pairTests; // collision distance tests over the whole run
+} HeadlessStats;
+
+void init_headless_config(HeadlessConfig* config);
+// Runs the simulation with no window, renderer, mixer or frame cap
+int run_headless(const HeadlessConfig* config, HeadlessStats* stats);
+void print_headless_stats(FILE* out, const HeadlessStats* stats);
+
+#endif
@@ -0,0 +1,134 @@
+#include "hud.h"
+#include "game.h"
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+const Vector2 DIGIT_POINTS[][7] = {
+    {{-10, 15}, {10, 15}, {10, -15}, {-10, -15}, {-10, 15}},         // 0
+    {{10, 15}, {10, -15}},                                           // 1
+    {{-10, -15}, {10, -15}, {10, 0}, {-10, 0}, {-10, 15}, {10, 15}}, // 2
+    {{-10, -15},
+     {10, -15},
+     {10, 0},
+     {-10, 0},
+     {10, 0},
+     {10, 15},
+     {-10, 15}},                                                     // 3
+    {{-10, -15}, {-10, 0}, {10, 0}, {10, -15}, {10, 15}},            // 4
+    {{10, -15}, {-10, -15}, {-10, 0}, {10, 0}, {10, 15}, {-10, 15}}, // 5
+    {{-10, -15}, {-10, 15}, {10, 15}, {10, 0}, {-10, 0}},            // 6
+    {{-10, -15}, {10, -15}, {10, 15}},                               // 7
+    {{-10, 15},
+     {-10, -15},
+     {10, -15},
+     {10, 15},
+     {-10, 15},
+     {-10, 0},
+     {10, 0}},                                           // 8
+    {{10, 15}, {10, -15}, {-10, -15}, {-10, 0}, {10, 0}} // 9
+};
+
+const int DIGIT_COUNTS[] = {5, 2, 6, 7, 5, 6, 5, 3, 7, 5};
+
+const float DIGIT_WIDTH = 35.0f;
+const float DIGIT_HEIGHT = 40.0f;
+
+const float SMALL_DIGIT_SCALE = 0.5f; // level and fps relative to score
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+// Score along the top right as before, the level under it and the fps in
+// the top left corner
+void init_hud(Hud* hud) {
+    for (int i = 0; i < NUM_HUD_READOUTS; i++) {
+        HudReadout* readout = &hud->readouts[i];
+        readout->value = HUD_HIDDEN;
+        readout->alignRight = 1;
+        readout->scale = 1.0f;
+        readout->numLines = 0;
+    }
+    hud->readouts[HUD_SCORE].anchor = create_vector(SCREEN_WIDTH, DIGIT_HEIGHT);
+
+    HudReadout* level = &hud->readouts[HUD_LEVEL];
+    level->scale = SMALL_DIGIT_SCALE;
+    level->anchor = create_vector(SCREEN_WIDTH, DIGIT_HEIGHT * 2);
+
+    HudReadout* fps = &hud->readouts[HUD_FPS];
+    fps->alignRight = 0;
+    fps->scale = SMALL_DIGIT_SCALE;
+    fps->anchor = create_vector(DIGIT_WIDTH * SMALL_DIGIT_SCALE,
+                                DIGIT_HEIGHT * SMALL_DIGIT_SCALE);
+}
+
+// Cheap to call every frame, the lines are only rebuilt on a new value.
+// HUD_HIDDEN or any other negative value draws nothing.
+void set_hud_value(Hud* hud, HudReadoutId id, int value) {
+    HudReadout* readout = &hud->readouts[id];
+    if (value < 0) {
+        value = HUD_HIDDEN;
+    }
+    if (value == readout->value) {
+        return;
+    }
+    readout->value = value;
+
+    int digits[MAX_DIGITS];
+    int numDigits = get_digits(value, digits);
+    Vector2 position = readout->anchor;
+    if (readout->alignRight) {
+        position.x -= DIGIT_WIDTH * readout->scale * numDigits;
+    }
+    readout->numLines =
+        number_lines(value, position, readout->scale, readout->lines);
+}
+
+void draw_hud(RenderBatch* batch, const Hud* hud) {
+    for (int i = 0; i < NUM_HUD_READOUTS; i++) {
+        const HudReadout* readout = &hud->readouts[i];
+        for (int j = 0; j < readout->numLines; j++) {
+            batch_line(batch, readout->lines[j][0], readout->lines[j][1]);
+        }
+    }
+}
+
+// Most significant first, returns how many. Negative numbers have none.
+int get_digits(int number, int digits[MAX_DIGITS]) {
+    if (number < 0) {
+        return 0;
+    }
+
+    int numDigits = 0;
+    int temp = number;
+    do {
+        numDigits++;
+        temp /= 10;
+    } while (temp != 0);
+
+    for (int i = numDigits - 1; i >= 0; i--) {
+        digits[i] = number % 10;
+        number /= 10;
+    }
+    return numDigits;
+}
+
+// Glyph centres start at position and step right, scaled about the centres.
+// Returns the number of lines written.
+int number_lines(int number, Vector2 position, float scale,
+                 Vector2 lines[MAX_NUMBER_LINES][2]) {
+    int digits[MAX_DIGITS];
+    int numDigits = get_digits(number, digits);
+
+    int numLines = 0;
+    for (int i = 0; i < numDigits; i++) {
+        int num = digits[i];
+        float x = position.x + DIGIT_WIDTH * scale * i;
+        for (int j = 1; j < DIGIT_COUNTS[num]; j++) {
+            Vector2 a = vector_mul(DIGIT_POINTS[num][j - 1], scale);
+            Vector2 b = vector_mul(DIGIT_POINTS[num][j], scale);
+            lines[numLines][0] = create_vector(x + a.x, position.y + a.y);
+            lines[numLines][1] = create_vector(x + b.x, position.y + b.y);
+            numLines++;
+        }
+    }
+    return numLines;
+}
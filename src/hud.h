@@ -0,0 +1,43 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include "batch.h"
+
+#define MAX_DIGITS 10       // enough for any non-negative int
+#define MAX_GLYPH_LINES 6   // most lines in one digit glyph
+#define MAX_NUMBER_LINES (MAX_DIGITS * MAX_GLYPH_LINES)
+#define HUD_HIDDEN -1       // value that hides a readout
+
+// Lives gets a slot here once the game has them
+typedef enum {
+    HUD_SCORE,
+    HUD_LEVEL,
+    HUD_FPS,
+    NUM_HUD_READOUTS,
+} HudReadoutId;
+
+// A number drawn from cached line segments, only rebuilt when it changes
+typedef struct {
+    int value;
+    int alignRight; // anchor is the right edge instead of the left
+    Vector2 anchor;
+    float scale;
+    int numLines;
+    Vector2 lines[MAX_NUMBER_LINES][2];
+} HudReadout;
+
+typedef struct {
+    HudReadout readouts[NUM_HUD_READOUTS];
+} Hud;
+
+extern const float DIGIT_WIDTH;
+extern const float DIGIT_HEIGHT;
+
+void init_hud(Hud* hud);
+void set_hud_value(Hud* hud, HudReadoutId id, int value);
+void draw_hud(RenderBatch* batch, const Hud* hud);
+int get_digits(int number, int digits[MAX_DIGITS]);
+int number_lines(int number, Vector2 position, float scale,
+                 Vector2 lines[MAX_NUMBER_LINES][2]);
+
+#endif
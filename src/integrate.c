@@ -0,0 +1,258 @@
+#include "integrate.h"
+#include <math.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) &&                              \
+    (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define INTEGRATE_X86
+#include <immintrin.h>
+#endif
+
+/*-----------------------------------STRUCTS----------------------------------*/
+
+typedef void (*IntegrateKernel)(float* x, float* y, const float* vx,
+                                const float* vy, int count, float deltaTime);
+typedef void (*WrapKernel)(float* x, float* y, const float* vx,
+                           const float* vy, int count, float deltaTime,
+                           float width, float height);
+
+typedef struct {
+    IntegrateKernel integrate;
+    WrapKernel integrateWrap;
+} Kernels;
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+static const char* const BACKEND_NAMES[NUM_INTEGRATE_BACKENDS] = {
+    "scalar",
+    "sse2",
+    "avx2",
+};
+
+/*------------------------------------SCALAR----------------------------------*/
+
+// Brings a coordinate back into [0, size). Anything that moved less than
+// one screen takes two selects instead of fmod(), and is exact where
+// fmod(v + size, size) was not. Coordinates further off, after a very long
+// tick or a runaway velocity, are brought within a screen by fmodf() first.
+float wrap_coordinate(float value, float size) {
+    if (value < -size || value >= 2 * size) {
+        value = fmodf(value, size);
+    }
+    value = value < 0 ? value + size : value;
+    return value >= size ? value - size : value;
+}
+
+static void integrate_scalar(float* x, float* y, const float* vx,
+                             const float* vy, int count, float deltaTime) {
+    for (int i = 0; i < count; i++) {
+        x[i] += vx[i] * deltaTime;
+        y[i] += vy[i] * deltaTime;
+    }
+}
+
+static void integrate_wrap_scalar(float* x, float* y, const float* vx,
+                                  const float* vy, int count, float deltaTime,
+                                  float width, float height) {
+    for (int i = 0; i < count; i++) {
+        x[i] = wrap_coordinate(x[i] + vx[i] * deltaTime, width);
+        y[i] = wrap_coordinate(y[i] + vy[i] * deltaTime, height);
+    }
+}
+
+#ifdef INTEGRATE_X86
+
+/*-------------------------------------SSE2-----------------------------------*/
+
+// Lanes too far off for the two selects are rare, so a vector holding one
+// is wrapped a lane at a time with wrap_coordinate() for the same result
+static __m128 wrap_sse2(__m128 value, __m128 size) {
+    __m128 zero = _mm_setzero_ps();
+    __m128 far = _mm_or_ps(_mm_cmplt_ps(value, _mm_sub_ps(zero, size)),
+                           _mm_cmpge_ps(value, _mm_add_ps(size, size)));
+    if (_mm_movemask_ps(far)) {
+        float lanes[4];
+        _mm_storeu_ps(lanes, value);
+        for (int i = 0; i < 4; i++) {
+            lanes[i] = wrap_coordinate(lanes[i], _mm_cvtss_f32(size));
+        }
+        return _mm_loadu_ps(lanes);
+    }
+    value = _mm_add_ps(value, _mm_and_ps(_mm_cmplt_ps(value, zero), size));
+    return _mm_sub_ps(value, _mm_and_ps(_mm_cmpge_ps(value, size), size));
+}
+
+static void integrate_sse2(float* x, float* y, const float* vx,
+                           const float* vy, int count, float deltaTime) {
+    __m128 dt = _mm_set1_ps(deltaTime);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 dx = _mm_mul_ps(_mm_loadu_ps(&vx[i]), dt);
+        __m128 dy = _mm_mul_ps(_mm_loadu_ps(&vy[i]), dt);
+        _mm_storeu_ps(&x[i], _mm_add_ps(_mm_loadu_ps(&x[i]), dx));
+        _mm_storeu_ps(&y[i], _mm_add_ps(_mm_loadu_ps(&y[i]), dy));
+    }
+    integrate_scalar(&x[i], &y[i], &vx[i], &vy[i], count - i, deltaTime);
+}
+
+static void integrate_wrap_sse2(float* x, float* y, const float* vx,
+                                const float* vy, int count, float deltaTime,
+                                float width, float height) {
+    __m128 dt = _mm_set1_ps(deltaTime);
+    __m128 w = _mm_set1_ps(width);
+    __m128 h = _mm_set1_ps(height);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 dx = _mm_mul_ps(_mm_loadu_ps(&vx[i]), dt);
+        __m128 dy = _mm_mul_ps(_mm_loadu_ps(&vy[i]), dt);
+        __m128 newX = _mm_add_ps(_mm_loadu_ps(&x[i]), dx);
+        __m128 newY = _mm_add_ps(_mm_loadu_ps(&y[i]), dy);
+        _mm_storeu_ps(&x[i], wrap_sse2(newX, w));
+        _mm_storeu_ps(&y[i], wrap_sse2(newY, h));
+    }
+    integrate_wrap_scalar(&x[i], &y[i], &vx[i], &vy[i], count - i, deltaTime,
+                          width, height);
+}
+
+/*-------------------------------------AVX2-----------------------------------*/
+
+// Compiled for AVX2 on its own so the rest of the build keeps the
+// baseline instruction set, and only called once the CPU says it can
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static __m256 wrap_avx2(__m256 value, __m256 size) {
+    __m256 zero = _mm256_setzero_ps();
+    __m256 low = _mm256_sub_ps(zero, size);
+    __m256 high = _mm256_add_ps(size, size);
+    __m256 far = _mm256_or_ps(_mm256_cmp_ps(value, low, _CMP_LT_OQ),
+                              _mm256_cmp_ps(value, high, _CMP_GE_OQ));
+    if (_mm256_movemask_ps(far)) {
+        float lanes[8];
+        _mm256_storeu_ps(lanes, value);
+        for (int i = 0; i < 8; i++) {
+            lanes[i] = wrap_coordinate(lanes[i], _mm256_cvtss_f32(size));
+        }
+        return _mm256_loadu_ps(lanes);
+    }
+    __m256 below = _mm256_cmp_ps(value, zero, _CMP_LT_OQ);
+    value = _mm256_add_ps(value, _mm256_and_ps(below, size));
+    __m256 above = _mm256_cmp_ps(value, size, _CMP_GE_OQ);
+    return _mm256_sub_ps(value, _mm256_and_ps(above, size));
+}
+
+AVX2_TARGET static void integrate_avx2(float* x, float* y, const float* vx,
+                                       const float* vy, int count,
+                                       float deltaTime) {
+    __m256 dt = _mm256_set1_ps(deltaTime);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 dx = _mm256_mul_ps(_mm256_loadu_ps(&vx[i]), dt);
+        __m256 dy = _mm256_mul_ps(_mm256_loadu_ps(&vy[i]), dt);
+        _mm256_storeu_ps(&x[i], _mm256_add_ps(_mm256_loadu_ps(&x[i]), dx));
+        _mm256_storeu_ps(&y[i], _mm256_add_ps(_mm256_loadu_ps(&y[i]), dy));
+    }
+    _mm256_zeroupper(); // the tail runs legacy SSE code
+    integrate_sse2(&x[i], &y[i], &vx[i], &vy[i], count - i, deltaTime);
+}
+
+AVX2_TARGET static void integrate_wrap_avx2(float* x, float* y,
+                                            const float* vx, const float* vy,
+                                            int count, float deltaTime,
+                                            float width, float height) {
+    __m256 dt = _mm256_set1_ps(deltaTime);
+    __m256 w = _mm256_set1_ps(width);
+    __m256 h = _mm256_set1_ps(height);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 dx = _mm256_mul_ps(_mm256_loadu_ps(&vx[i]), dt);
+        __m256 dy = _mm256_mul_ps(_mm256_loadu_ps(&vy[i]), dt);
+        __m256 newX = _mm256_add_ps(_mm256_loadu_ps(&x[i]), dx);
+        __m256 newY = _mm256_add_ps(_mm256_loadu_ps(&y[i]), dy);
+        _mm256_storeu_ps(&x[i], wrap_avx2(newX, w));
+        _mm256_storeu_ps(&y[i], wrap_avx2(newY, h));
+    }
+    _mm256_zeroupper();
+    integrate_wrap_sse2(&x[i], &y[i], &vx[i], &vy[i], count - i, deltaTime,
+                        width, height);
+}
+
+#endif
+
+/*----------------------------------DISPATCH----------------------------------*/
+
+// Scalar until init_integrate(), so library users get correct results
+// without calling it
+static IntegrateBackend backend = INTEGRATE_SCALAR;
+static Kernels kernels = {integrate_scalar, integrate_wrap_scalar};
+
+static int backend_supported(IntegrateBackend choice) {
+    switch (choice) {
+    case INTEGRATE_SCALAR:
+        return 1;
+#ifdef INTEGRATE_X86
+    case INTEGRATE_SSE2:
+        return 1; // part of the x86-64 baseline
+    case INTEGRATE_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return 0;
+    }
+}
+
+// Returns 0 and keeps the current kernels if the CPU or build lacks it
+int set_integrate_backend(IntegrateBackend choice) {
+    if (!backend_supported(choice)) {
+        return 0;
+    }
+
+    switch (choice) {
+#ifdef INTEGRATE_X86
+    case INTEGRATE_SSE2:
+        kernels.integrate = integrate_sse2;
+        kernels.integrateWrap = integrate_wrap_sse2;
+        break;
+    case INTEGRATE_AVX2:
+        kernels.integrate = integrate_avx2;
+        kernels.integrateWrap = integrate_wrap_avx2;
+        break;
+#endif
+    default:
+        kernels.integrate = integrate_scalar;
+        kernels.integrateWrap = integrate_wrap_scalar;
+        break;
+    }
+    backend = choice;
+    return 1;
+}
+
+// Picks the widest kernels this CPU runs. Call before any other thread
+// starts integrating, the selection itself is not synchronised.
+IntegrateBackend init_integrate(void) {
+    for (int i = NUM_INTEGRATE_BACKENDS - 1; i > INTEGRATE_SCALAR; i--) {
+        if (set_integrate_backend((IntegrateBackend)i)) {
+            return backend;
+        }
+    }
+    set_integrate_backend(INTEGRATE_SCALAR);
+    return backend;
+}
+
+IntegrateBackend integrate_backend(void) { return backend; }
+
+const char* integrate_backend_name(IntegrateBackend choice) {
+    return BACKEND_NAMES[choice];
+}
+
+// x += vx * dt over whole columns, no wrapping
+void integrate(float* x, float* y, const float* vx, const float* vy,
+               int count, float deltaTime) {
+    kernels.integrate(x, y, vx, vy, count, deltaTime);
+}
+
+// As integrate(), then wraps onto the torus of the given size with
+// wrap_coordinate(), however far an entity moved
+void integrate_wrap(float* x, float* y, const float* vx, const float* vy,
+                    int count, float deltaTime, float width, float height) {
+    kernels.integrateWrap(x, y, vx, vy, count, deltaTime, width, height);
+}
@@ -0,0 +1,25 @@
+#ifndef INTEGRATE_H
+#define INTEGRATE_H
+
+// Instruction sets the kernels can run on, best last
+typedef enum {
+    INTEGRATE_SCALAR,
+    INTEGRATE_SSE2,
+    INTEGRATE_AVX2,
+    NUM_INTEGRATE_BACKENDS,
+} IntegrateBackend;
+
+// Every backend does the same float multiply, add and compare in the same
+// order with no fused multiply-add, so they agree bit for bit and a run
+// replays identically on any machine
+IntegrateBackend init_integrate(void);
+int set_integrate_backend(IntegrateBackend backend);
+IntegrateBackend integrate_backend(void);
+const char* integrate_backend_name(IntegrateBackend backend);
+float wrap_coordinate(float value, float size);
+void integrate(float* x, float* y, const float* vx, const float* vy,
+               int count, float deltaTime);
+void integrate_wrap(float* x, float* y, const float* vx, const float* vy,
+                    int count, float deltaTime, float width, float height);
+
+#endif
@@ -0,0 +1,191 @@
+#include "jobs.h"
+#include <SDL2/SDL_cpuinfo.h>
+#include <SDL2/SDL_timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) &&                              \
+    (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define JOBS_X86
+#include <immintrin.h>
+#endif
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+// One worker per core besides the caller
+int default_workers(void) {
+    int workers = SDL_GetCPUCount() - 1;
+    if (workers < 0) {
+        return 0;
+    }
+    return workers > MAX_WORKERS ? MAX_WORKERS : workers;
+}
+
+// One step of a wait on another thread. Pausing keeps the spin off the
+// memory bus and out of a sibling hyperthread's way, and once the wait has
+// gone on for a while the core is handed over in case the thread being
+// waited on needs it, as it does when there are more threads than cores.
+static void wait_step(int* spins) {
+    if (++*spins < JOB_SPIN_LIMIT) {
+#if defined(JOBS_X86)
+        _mm_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+        __asm__ __volatile__("yield");
+#endif
+        return;
+    }
+    *spins = 0;
+    SDL_Delay(0);
+}
+
+// Claims chunks from the thread's own span, then steals from the others
+static void run_chunks(JobSystem* jobs, int thread) {
+    int numThreads = jobs->numWorkers + 1;
+    for (int i = 0; i < numThreads; i++) {
+        JobSpan* span = &jobs->spans[(thread + i) % numThreads];
+        int chunk;
+        while ((chunk = SDL_AtomicAdd(&span->next, 1)) < span->end) {
+            int begin = chunk * jobs->chunkSize;
+            int end = begin + jobs->chunkSize;
+            if (end > jobs->count) {
+                end = jobs->count;
+            }
+            jobs->func(jobs->data, begin, end, thread);
+            SDL_AtomicAdd(&jobs->done, 1);
+        }
+    }
+}
+
+static int worker_main(void* data) {
+    JobWorker* worker = (JobWorker*)data;
+    JobSystem* jobs = worker->system;
+    int seen = 0;
+
+    SDL_LockMutex(jobs->lock);
+    while (1) {
+        while (!jobs->quit && jobs->generation == seen) {
+            SDL_CondWait(jobs->wake, jobs->lock);
+        }
+        if (jobs->quit) {
+            break;
+        }
+        // Joining under the lock keeps run_jobs() from resetting the spans
+        // under a worker that woke late for an earlier run
+        seen = jobs->generation;
+        SDL_AtomicAdd(&jobs->busy, 1);
+        SDL_UnlockMutex(jobs->lock);
+
+        run_chunks(jobs, worker->thread);
+
+        SDL_AtomicAdd(&jobs->busy, -1);
+        SDL_LockMutex(jobs->lock);
+    }
+    SDL_UnlockMutex(jobs->lock);
+    return 0;
+}
+
+// numWorkers of 0 gives a system that runs everything on the caller
+JobSystem* init_jobs(int numWorkers) {
+    JobSystem* jobs = (JobSystem*)calloc(1, sizeof(JobSystem));
+    if (!jobs) {
+        fprintf(stderr, "Failed to allocate job system!\n");
+        return NULL;
+    }
+    if (numWorkers > MAX_WORKERS) {
+        numWorkers = MAX_WORKERS;
+    }
+
+    jobs->lock = SDL_CreateMutex();
+    jobs->wake = SDL_CreateCond();
+    if (!jobs->lock || !jobs->wake) {
+        fprintf(stderr, "Failed to create job system locks!\n");
+        free_jobs(jobs);
+        return NULL;
+    }
+
+    for (int i = 0; i < numWorkers; i++) {
+        jobs->workers[i].system = jobs;
+        jobs->workers[i].thread = i + 1;
+        jobs->threads[i] =
+            SDL_CreateThread(worker_main, "worker", &jobs->workers[i]);
+        if (!jobs->threads[i]) {
+            fprintf(stderr, "Failed to start worker thread!\n");
+            free_jobs(jobs);
+            return NULL;
+        }
+        jobs->numWorkers++;
+    }
+    return jobs;
+}
+
+void free_jobs(JobSystem* jobs) {
+    if (!jobs) {
+        return;
+    }
+
+    if (jobs->lock) {
+        SDL_LockMutex(jobs->lock);
+        jobs->quit = 1;
+        SDL_CondBroadcast(jobs->wake);
+        SDL_UnlockMutex(jobs->lock);
+    }
+    for (int i = 0; i < jobs->numWorkers; i++) {
+        SDL_WaitThread(jobs->threads[i], NULL);
+    }
+    SDL_DestroyCond(jobs->wake);
+    SDL_DestroyMutex(jobs->lock);
+    free(jobs);
+}
+
+// Threads a run is split across, callers size per thread scratch with it
+int job_threads(const JobSystem* jobs) {
+    return jobs ? jobs->numWorkers + 1 : 1;
+}
+
+// Calls func over [0, count) in chunks of chunkSize items and returns once
+// every chunk is done. Which thread runs a chunk varies between runs, so
+// func must only write to its own items or to per thread state. A NULL
+// system, no workers or a single chunk all run inline on the caller.
+void run_jobs(JobSystem* jobs, JobFunc func, void* data, int count,
+              int chunkSize) {
+    if (count <= 0) {
+        return;
+    }
+    int numChunks = (count + chunkSize - 1) / chunkSize;
+    if (!jobs || jobs->numWorkers == 0 || numChunks == 1) {
+        func(data, 0, count, 0);
+        return;
+    }
+
+    int spins = 0;
+    SDL_LockMutex(jobs->lock);
+    while (SDL_AtomicGet(&jobs->busy) > 0) {
+        // A worker is still leaving the previous run
+        SDL_UnlockMutex(jobs->lock);
+        wait_step(&spins);
+        SDL_LockMutex(jobs->lock);
+    }
+
+    jobs->func = func;
+    jobs->data = data;
+    jobs->count = count;
+    jobs->chunkSize = chunkSize;
+    SDL_AtomicSet(&jobs->done, 0);
+
+    // Contiguous spans keep each thread on neighbouring items
+    int numThreads = jobs->numWorkers + 1;
+    for (int i = 0; i < numThreads; i++) {
+        SDL_AtomicSet(&jobs->spans[i].next, numChunks * i / numThreads);
+        jobs->spans[i].end = numChunks * (i + 1) / numThreads;
+    }
+    jobs->generation++;
+    SDL_CondBroadcast(jobs->wake);
+    SDL_UnlockMutex(jobs->lock);
+
+    run_chunks(jobs, 0);
+    spins = 0;
+    while (SDL_AtomicGet(&jobs->done) < numChunks) {
+        // Only the last few chunks are left, which are short
+        wait_step(&spins);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_thread.h>
+
+#define MAX_WORKERS 31 // worker threads, the caller makes one more
+#define MAX_JOB_THREADS (MAX_WORKERS + 1)
+#define JOB_CACHE_LINE 64
+#define JOB_SPIN_LIMIT 64 // pauses in a wait before yielding the core
+
+// Called for items [begin, end) of a run. thread is 0 for the caller and
+// 1..numWorkers for the workers, for per thread scratch and counters.
+typedef void (*JobFunc)(void* data, int begin, int end, int thread);
+
+// The chunks of a run still owned by one thread. Each thread starts on its
+// own span and steals from the front of the others once it is empty, so
+// claiming a chunk is one atomic add and never takes a lock.
+typedef struct {
+    SDL_atomic_t next; // next chunk to claim
+    int end;           // one past the last chunk of the span
+    char pad[JOB_CACHE_LINE - sizeof(SDL_atomic_t) - sizeof(int)];
+} JobSpan;
+
+typedef struct JobSystem JobSystem;
+
+typedef struct {
+    JobSystem* system;
+    int thread;
+} JobWorker;
+
+// Runs one parallel loop at a time, submitted and waited on by a single
+// caller thread that also takes part. Workers sleep between runs.
+struct JobSystem {
+    int numWorkers;
+    SDL_Thread* threads[MAX_WORKERS];
+    JobWorker workers[MAX_WORKERS];
+    JobSpan spans[MAX_JOB_THREADS];
+    SDL_mutex* lock;
+    SDL_cond* wake;
+    int generation; // bumped per run, under lock
+    int quit;
+    SDL_atomic_t busy; // workers inside the current run
+    SDL_atomic_t done; // chunks finished in the current run
+    JobFunc func;
+    void* data;
+    int count;
+    int chunkSize;
+};
+
+int default_workers(void);
+JobSystem* init_jobs(int numWorkers);
+void free_jobs(JobSystem* jobs);
+int job_threads(const JobSystem* jobs);
+void run_jobs(JobSystem* jobs, JobFunc func, void* data, int count,
+              int chunkSize);
+
+#endif
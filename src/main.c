@@ -1,3 +1,12 @@
+#include "game.h"
+#include "headless.h"
+#include "frames.h"
+#include "integrate.h"
+#include "pacer.h"
+#include "profile.h"
+#include "render.h"
+#include "replay.h"
+#include "sound.h"
 #include "vec.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_events.h>
@@ -17,153 +26,21 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 /*----------------------------------CONSTANTS---------------------------------*/
 
-const char* const EXPLOSION_PATH = "../sounds/explosion.wav";
-const char* const SHOOT_PATH = "../sounds/shoot.wav";
-const char* const HIT_PATH = "../sounds/hit.wav";
-const char* const ALIEN_PATH = "../sounds/alien.wav";
-const char* const RAN_PATH = "../sounds/random.wav";
-
-// Screen dimensions
-const int SCREEN_WIDTH = 1000;
-const int SCREEN_HEIGHT = 800;
-
-// Time constants
-const float MS_TO_SECONDS_F = 1000.0f;
-const Uint32 MS_TO_SECONDS = 1000;
-const int MAX_FPS = 240;
-const Uint32 TICK_PER_FRAME = MS_TO_SECONDS / MAX_FPS;
-
-// Ship constant
-const int NUM_SHIP_POINTS = 5;
-const Vector2 INIT_SHIP_SHAPE[] = {
-    {0, -15}, {11.25, 15}, {10.75, 11.25}, {-10.75, 11.25}, {-11.25, 15},
-};
-
-const int NUM_ALIEN_POINTS = 13;
-const Vector2 INIT_ALIEN_SHAPE[] = {
-    {-10, 30}, {10, 30}, {25, 25},  {15, 15},  {10, 15},  {10, 5},  {5, 0},
-    {-5, 0},   {-10, 5}, {-10, 15}, {-15, 15}, {-25, 25}, {-10, 30}};
-
-const int NUM_FLAME_POINTS = 3;
-const Vector2 INIT_FLAME_SHAPE[] = {
-    {9, 11.25},
-    {-9, 11.25},
-    {0, 26.25},
-};
-
-const Vector2 DIGIT_POINTS[][7] = {
-    {{-10, 15}, {10, 15}, {10, -15}, {-10, -15}, {-10, 15}},         // 0
-    {{10, 15}, {10, -15}},                                           // 1
-    {{-10, -15}, {10, -15}, {10, 0}, {-10, 0}, {-10, 15}, {10, 15}}, // 2
-    {{-10, -15},
-     {10, -15},
-     {10, 0},
-     {-10, 0},
-     {10, 0},
-     {10, 15},
-     {-10, 15}},                                                     // 3
-    {{-10, -15}, {-10, 0}, {10, 0}, {10, -15}, {10, 15}},            // 4
-    {{10, -15}, {-10, -15}, {-10, 0}, {10, 0}, {10, 15}, {-10, 15}}, // 5
-    {{-10, -15}, {-10, 15}, {10, 15}, {10, 0}, {-10, 0}},            // 6
-    {{-10, -15}, {10, -15}, {10, 15}},                               // 7
-    {{-10, 15},
-     {-10, -15},
-     {10, -15},
-     {10, 15},
-     {-10, 15},
-     {-10, 0},
-     {10, 0}},                                           // 8
-    {{10, 15}, {10, -15}, {-10, -15}, {-10, 0}, {10, 0}} // 9
-};
-
-const int DIGIT_COUNTS[] = {5, 2, 6, 7, 5, 6, 5, 3, 7, 5};
-
-const int FLICKER_RATE = 3;
-const float PLAYER_SPEED = 2000.0f;
-const float PLAYER_SHOOT_FORCE = 30.0f;
-const float PLAYER_ROTATION_RATE = 5.5f;
-const float PLAYER_DRAG = 3.00f;
-const float VERTICLE = M_PI / 2;
-
-const Vector2 VECTOR2_ZERO = {0, 0};
-
-const float MIN_PARTICLE_SPEED = 20.0f;
-const float MAX_PARTICLE_SPEED = 80.0f;
-const float MIN_RADIUS = 2.0f;
-const float MAX_RADIUS = 4.0f;
-
-const int INIT_CAPACITY = 20;
-const int INIT_NUM_ASTEROIDS = 5;
-
-const float PROJ_SPEED = 1000.0f;
-const Uint32 PROJ_TIME = 10000;
-const int PROJ_THICKNESS = 2;
-const int BROKEN_ASTEROID_NUM = 2;
-
-const Uint32 RESPAWN_TIME = 2000;
-const Uint32 FIRE_RATE = 150;
-
-const int NUM_PARTICLES = 30;
-const int NUM_LINES = 4;
-const float LINE_RADIUS = 20.0f;
-const float DIGIT_WIDTH = 35.0f;
-const float DIGIT_HEIGHT = 40.0f;
-const float DRIFT_FRACTION = 0.4f;
-
-const float ALIEN_SPEED = 150.0f;
-const Uint32 ALIEN_FIRE_RATE = 1000;
-const float PLAYER_SIZE = 15.0f;
-const float ALIEN_SIZE = 25.0f;
-const Uint32 PLAYER_SAFE_TIME = 1000;
-
-/*------------------------------------ENUMS-----------------------------------*/
-typedef enum {
-    OK,
-    WINDOW_ERROR,
-    GAME_ERROR,
-} ExitStatus;
-
-typedef enum {
-    SMALL = 5,
-    MEDIUM = 9,
-    LARGE = 12,
-} AsteroidSize;
-
-typedef enum {
-    SMALL_POINTS = 8,
-    MEDIUM_POINTS = 10,
-    LARGE_POINTS = 13,
-} AsteroidPoints;
-
-typedef enum {
-    SMALL_SCORE = 100,
-    MEDIUM_SCORE = 50,
-    LARGE_SCORE = 20,
-} AsteroidScores;
-
-const AsteroidScores SCORES[] = {SMALL_SCORE, MEDIUM_SCORE, LARGE_SCORE};
-const AsteroidPoints ASTEROID_POINTS[] = {SMALL_POINTS, MEDIUM_POINTS,
-                                          LARGE_POINTS};
-
-const AsteroidSize ASTEROID_SIZES[] = {SMALL, MEDIUM, LARGE};
-const float MIN_ASTEROID_SPEEDS[] = {100.0f, 40.0f, 20.0f};
-const float MAX_ASTEROID_SPEEDS[] = {200.0f, 80.0f, 30.0f};
+const int DEFAULT_MAX_FPS = 240;
+const int MIX_BUFFER_SAMPLES = 2048;
 
-/*-----------------------------------STRUCTS----------------------------------*/
-typedef struct {
-    float deltaTime;
-    Uint32 time;
-    Uint32 frameTime;
-    Uint32 lastSecond;
-    Uint32 lastFrame;
-    int frames;
-    int fps;
-} Time;
+const int DEFAULT_TICK_RATE = 60; // simulation ticks per second
+// Slower ticks make the per tick drag overshoot and let shots and the ship
+// cross too much of the screen at once
+const int MIN_TICK_RATE = 10;
+const int MAX_CATCH_UP_TICKS = 5; // ticks run in one frame before time drops
 
+/*-----------------------------------STRUCTS----------------------------------*/
 typedef struct {
     int quit; // bool that checks if should close the window/quit (key press)
     int width;
@@ -171,135 +48,83 @@ typedef struct {
     char* title;
     SDL_Window* window;
     SDL_Renderer* renderer;
+    RenderBatch batch;
+    Hud hud;
+    FramePacer pacer;
 } Window;
 
+// Accumulates real time and hands it to the simulation in fixed ticks
 typedef struct {
-    int moving;
-    int shoot;
-    int crashed;
-    Vector2 position;
-    Vector2 velocity;
-    float rotation;
-    Uint32 lastShot;
-    Uint32 crashTime;
-} Player;
-
-typedef struct {
-    Uint32 seed;
-    Vector2 velocity;
-    Vector2 position;
-    AsteroidSize size;
-} Asteroid;
-
-typedef struct {
-    Uint32 spawnTime;
-    Vector2 velocity;
-    Vector2 position;
-} Projectile;
-
-typedef struct {
-    float angle;
-    Uint32 spawnTime;
-    Vector2 position;
-    Vector2 velocity;
-} Line;
-
-typedef struct {
-    Line** lines;
-    Projectile** particles;
-} CrashInfo;
-
-typedef struct {
-    int hit;
-    float rotation; // shoot angle
-    Uint32 lastShot;
-    Vector2 position;
-    Vector2 velocity;
-} Alien;
-
+    float step;         // seconds per tick
+    int maxTicks;       // catch-up cap, excess time is dropped
+    Uint64 tick;        // ticks simulated so far
+    Uint64 lastCounter; // performance counter at the previous frame
+    double accumulator; // real time not yet simulated, in seconds
+    float alpha;        // fraction of a tick left in the accumulator
+} FixedStep;
+
+// Owned by the simulation thread while it runs, except input and quit
+// which the main thread writes
 typedef struct {
-    Mix_Chunk* explosion;
-    Mix_Chunk* shoot;
-    Mix_Chunk* hit;
-    Mix_Chunk* alien;
-    Mix_Chunk* ran;
-} SoundManager;
+    State* state;
+    Time time;
+    FixedStep* step;
+    ReplayWriter* record;
+    SDL_atomic_t input; // latest InputFlags sampled by the main thread
+    SDL_atomic_t quit;
+    FrameBuffer frames;
+} Simulation;
 
 typedef struct {
-    int score;
-    int asteroidCapacity;
-    int asteroidSize;
-    int projectileCapacity;
-    int projectileSize;
-    int alienProjCapacity;
-    int alienProjSize;
-    int level;
-    Player* player;
-    Alien* alien;
-    Asteroid** asteroids;
-    Projectile** projectiles;
-    Projectile** alienProjs;
-    CrashInfo* crashInfo;
-    SoundManager* sounds;
-} State;
+    int headless;
+    int tickRate;
+    const char* recordPath; // NULL unless --record was given
+    const char* replayPath; // NULL unless --replay was given
+    int profile;            // show the profiler overlay from the start
+    const char* profileCsv;
+    const char* profileTrace;
+    int workers; // job threads besides the main one
+    int sync;    // simulate on the main thread between renders
+    PaceMode pace;
+    int maxFps; // frame cap in PACE_CAPPED
+    HeadlessConfig headlessConfig;
+} Options;
 
 /*----------------------------------PROTOTYPES--------------------------------*/
+int parse_options(int argc, char* argv[], Options* options);
+int run_headless_main(const Options* options);
 Time* init_time(void);
 void update_time(Time* time);
-void limit_fps(Time* time);
-Window* init_window(const int width, const int height, const char* title);
+void report_pacing(const FramePacer* pacer);
+void show_fps(Window* window, const Time* time, const Profiler* profiler);
+void count_frame(const Window* window, const State* state, Uint64* pairTests,
+                 ProfileCounters* counters);
+void init_fixed_step(FixedStep* step, int tickRate, int maxTicks);
+int advance_fixed_step(FixedStep* step);
+void wait_fixed_step(FixedStep* step);
+void run_ticks(State* state, Time* gameTime, FixedStep* step, Uint8 input,
+               int ticks, ReplayWriter* record);
+Window* init_window(const int width, const int height, const char* title,
+                    PaceMode pace, int maxFps);
 void close_window(Window* window);
-void update(Window* window, State* state, Time* gameTime);
-void render(Window* window, State* state, Uint32 time);
-void handle_events(Window* window, SDL_Event* event, Player* player,
-                   float deltaTime);
-Player* init_ship(const float x, const float y);
-State* init_state(void);
-void free_player(Player* player);
-void free_state(State* state);
-void update_player(Player* player, float deltaTime);
-void draw_player(SDL_Renderer* renderer, Player* player, Uint32 time);
-Asteroid* init_asteroid(AsteroidSize size, Vector2 position, Uint32 seed);
-void draw_asteroid(SDL_Renderer* renderer, Asteroid* asteroid);
-void add_asteroid(State* state, Asteroid* asteroid);
-void update_asteroids(Asteroid** asteroids, int size, float deltaTime);
-void draw_asteroids(SDL_Renderer* renderer, Asteroid** asteroids, int size);
-void spawn_asteroids(State* state, int num, Uint32 seed);
-int asteroid_size_idx(AsteroidSize size);
-Projectile* init_projectile(Vector2 position, float angle, Uint32 time);
-void add_projectile(State* state, Uint32 time);
-void update_projectile(Projectile* proj, float deltaTime);
-void update_projectiles(Projectile** projectiles, int size, float deltaTime);
-void draw_projectile(SDL_Renderer* renderer, Projectile* proj);
-void draw_projectiles(SDL_Renderer* renderer, Projectile** projectiles,
-                      int size);
-void delete_projectiles(State* state, Uint32 time);
-void update_shoot(State* state, Time* time);
-void detect_crash(State* state, Uint32 time);
-void detect_Shoot(State* state);
-void on_destroy(State* state, AsteroidSize size, Vector2 position, Uint32 seed);
-void on_crash(CrashInfo* crashInfo, Player* player, Uint32 time);
-void respawn(Player* player);
-CrashInfo* init_crashinfo(void);
-void draw_crashinfo(SDL_Renderer* renderer, CrashInfo* crashInfo);
-void update_crashinfo(CrashInfo* crashInfo, float deltaTime);
-void free_crashinfo(CrashInfo* crashInfo);
-void draw_score(SDL_Renderer* renderer, int score);
-void draw_digit(SDL_Renderer* renderer, Vector2 position, int num);
-void play_sound(Mix_Chunk* sound);
-SoundManager* init_soundmanager(const char* explosion, const char* shoot,
-                                const char* hit, const char* alien,
-                                const char* ran);
-void free_soundmanager(SoundManager* sounds);
-void player_shoot(State* state, Uint32 time);
-int* get_digits(int number, int* num_digits);
-Alien* init_alien();
-void update_angle(Alien* alien, Vector2 playerPosition);
-void alien_shoot(State* state, Uint32 time);
-void update_alien(State* state, Time* time);
-void draw_alien(SDL_Renderer* renderer, Alien* alien);
-
-int main() {
+void update(Window* window, State* state, Time* gameTime, FixedStep* step,
+            ReplayWriter* record);
+Uint8 handle_events(Window* window, SDL_Event* event, Profiler* profiler);
+void run_synced(Window* window, State* state, Time* gameTime, FixedStep* step,
+                ReplayWriter* record, Profiler* profiler);
+int run_pipelined(Window* window, State* state, Time* gameTime,
+                  FixedStep* step, ReplayWriter* record, Profiler* profiler);
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (parse_options(argc, argv, &options) != OK) {
+        return GAME_ERROR;
+    }
+    init_integrate();
+
+    if (options.headless || options.replayPath) {
+        return run_headless_main(&options);
+    }
 
     Time* gameTime = init_time();
     if (!gameTime) {
@@ -307,7 +132,8 @@ int main() {
         return GAME_ERROR;
     }
 
-    Window* window = init_window(SCREEN_WIDTH, SCREEN_HEIGHT, "asteroids");
+    Window* window = init_window(SCREEN_WIDTH, SCREEN_HEIGHT, "asteroids",
+                                 options.pace, options.maxFps);
     if (!window) {
         fprintf(stderr, "Failed to initialize window!\n");
         free(gameTime);
@@ -322,57 +148,396 @@ int main() {
         return GAME_ERROR;
     }
 
+    state->sounds = init_soundmanager(ASSET_DATA, ASSETS, NUM_ASSETS);
+    if (!state->sounds) {
+        fprintf(stderr, "Failed to initialize sound manager!\n");
+        free_state(state);
+        close_window(window);
+        free(gameTime);
+        return GAME_ERROR;
+    }
+
+    FixedStep step;
+    init_fixed_step(&step, options.tickRate, MAX_CATCH_UP_TICKS);
+    gameTime->deltaTime = step.step;
+
+    // The seed and tick length are all a replay needs besides the inputs
+    ReplayHeader header = {(Uint32)time(NULL), step.step};
+    ReplayWriter* record = NULL;
+    if (options.recordPath) {
+        record = open_replay_writer(options.recordPath, &header);
+        if (!record) {
+            free_state(state);
+            close_window(window);
+            free(gameTime);
+            return GAME_ERROR;
+        }
+    }
+
+    state->jobs = init_jobs(options.workers);
+    if (!state->jobs) {
+        close_replay_writer(record);
+        free_state(state);
+        close_window(window);
+        free(gameTime);
+        return GAME_ERROR;
+    }
+
+    // Only allocated when asked for, every profile call is a no-op on NULL
+    Profiler* profiler = NULL;
+    if (options.profile || options.profileCsv || options.profileTrace) {
+        profiler = init_profiler(options.profileCsv, options.profileTrace);
+        if (!profiler) {
+            free_jobs(state->jobs);
+            close_replay_writer(record);
+            free_state(state);
+            close_window(window);
+            free(gameTime);
+            return GAME_ERROR;
+        }
+        profiler->overlay = options.profile;
+    }
+
     // Initialize asteroids
-    spawn_asteroids(state, INIT_NUM_ASTEROIDS, time(NULL));
+    seed_state(state, header.seed);
+    spawn_asteroids(state, INIT_NUM_ASTEROIDS);
 
-    while (!window->quit) {
-        update_time(gameTime);
-        update(window, state, gameTime);
-        render(window, state, gameTime->time);
-        limit_fps(gameTime);
+    int status = OK;
+    if (options.sync) {
+        run_synced(window, state, gameTime, &step, record, profiler);
+    } else {
+        status = run_pipelined(window, state, gameTime, &step, record,
+                               profiler);
     }
 
+    report_pacing(&window->pacer);
+
     // Cleanup
+    free_profiler(profiler);
+    free_jobs(state->jobs);
+    close_replay_writer(record);
     free_state(state);
     close_window(window);
     free(gameTime);
 
+    return status;
+}
+
+// Update and render back to back on this thread, so every phase shows up
+// in the profiler
+void run_synced(Window* window, State* state, Time* gameTime, FixedStep* step,
+                ReplayWriter* record, Profiler* profiler) {
+    state->profiler = profiler;
+    Uint64 pairTests = state->pairTests;
+    while (!window->quit) {
+        begin_frame(profiler);
+        update_time(gameTime);
+        update(window, state, gameTime, step, record);
+        flush_sounds(state->sounds, gameTime->lastFrame);
+        show_fps(window, gameTime, profiler);
+        render(&window->batch, &window->hud, state, gameTime->time,
+               step->alpha);
+
+        Uint64 start = profile_begin(profiler, PHASE_DELAY);
+        pace_frame(&window->pacer);
+        profile_end(profiler, PHASE_DELAY, start);
+
+        if (profiler) {
+            ProfileCounters counters;
+            count_frame(window, state, &pairTests, &counters);
+            end_frame(profiler, &counters);
+            export_frames(profiler);
+        }
+    }
+}
+
+static void publish_state(Simulation* sim) {
+    SimFrame* frame = back_frame(&sim->frames);
+    if (!save_view(sim->state, sim->step->tick, &frame->view)) {
+        return; // the renderer keeps showing the previous tick
+    }
+    frame->tick = sim->step->tick;
+    frame->time = sim->time.time;
+    frame->counter = sim->step->lastCounter;
+    publish_frame(&sim->frames);
+}
+
+// Simulation thread: ticks on its own clock with the latest input the
+// main thread sampled, publishing a frame after each batch of ticks
+static int simulation_main(void* data) {
+    Simulation* sim = (Simulation*)data;
+    publish_state(sim);
+    while (!SDL_AtomicGet(&sim->quit)) {
+        Uint8 input = (Uint8)SDL_AtomicGet(&sim->input);
+        int ticks = advance_fixed_step(sim->step);
+        run_ticks(sim->state, &sim->time, sim->step, input, ticks,
+                  sim->record);
+        if (ticks > 0) {
+            publish_state(sim);
+        }
+        wait_fixed_step(sim->step);
+    }
+    return 0;
+}
+
+// Between the previous and the current positions of the frame, by the
+// wall time since it was simulated
+static float frame_alpha(const SimFrame* frame, float step) {
+    double elapsed = (double)(SDL_GetPerformanceCounter() - frame->counter) /
+                     SDL_GetPerformanceFrequency();
+    float alpha = (float)(elapsed / step);
+    return alpha < 0 ? 0 : (alpha > 1 ? 1 : alpha);
+}
+
+// The simulation runs on its own thread and this one polls input and
+// draws the newest published tick, so a slow present never holds up a
+// tick. Sim phases are not profiled in this mode, see --sync.
+int run_pipelined(Window* window, State* state, Time* gameTime,
+                  FixedStep* step, ReplayWriter* record, Profiler* profiler) {
+    // The renderer's own copy of the state, loaded from each new frame
+    State* view = init_state();
+    if (!view) {
+        fprintf(stderr, "Failed to initialize render state!\n");
+        return GAME_ERROR;
+    }
+    view->profiler = profiler;
+
+    Simulation sim;
+    sim.state = state;
+    sim.time = *gameTime;
+    sim.step = step;
+    sim.record = record;
+    SDL_AtomicSet(&sim.input, 0);
+    SDL_AtomicSet(&sim.quit, 0);
+    init_frame_buffer(&sim.frames);
+    SDL_Thread* thread = SDL_CreateThread(simulation_main, "simulation", &sim);
+    if (!thread) {
+        fprintf(stderr, "Failed to start simulation thread!\n");
+        free_frame_buffer(&sim.frames);
+        free_state(view);
+        return GAME_ERROR;
+    }
+
+    Uint64 shownTick = 0;
+    int loaded = 0;
+    Uint64 pairTests = 0;
+    while (!window->quit) {
+        begin_frame(profiler);
+        update_time(gameTime);
+
+        SDL_Event event;
+        Uint64 start = profile_begin(profiler, PHASE_EVENTS);
+        Uint8 input = handle_events(window, &event, profiler);
+        SDL_AtomicSet(&sim.input, input);
+        profile_end(profiler, PHASE_EVENTS, start);
+
+        // The manager pointer is fixed before the thread starts, only the
+        // pending counts are shared
+        flush_sounds(state->sounds, gameTime->lastFrame);
+
+        const SimFrame* frame = latest_frame(&sim.frames);
+        if (frame && (!loaded || frame->tick != shownTick)) {
+            loaded = load_view(view, &frame->view, NULL);
+            shownTick = frame->tick;
+        }
+        if (loaded) {
+            float alpha = frame_alpha(frame, step->step);
+            show_fps(window, gameTime, profiler);
+            render(&window->batch, &window->hud, view, frame->time, alpha);
+        }
+
+        start = profile_begin(profiler, PHASE_DELAY);
+        pace_frame(&window->pacer);
+        profile_end(profiler, PHASE_DELAY, start);
+
+        if (profiler) {
+            ProfileCounters counters;
+            count_frame(window, view, &pairTests, &counters);
+            end_frame(profiler, &counters);
+            export_frames(profiler);
+        }
+    }
+
+    SDL_AtomicSet(&sim.quit, 1);
+    SDL_WaitThread(thread, NULL);
+    free_frame_buffer(&sim.frames);
+    free_state(view);
+    return OK;
+}
+
+int parse_options(int argc, char* argv[], Options* options) {
+    options->headless = 0;
+    options->tickRate = DEFAULT_TICK_RATE;
+    options->recordPath = NULL;
+    options->replayPath = NULL;
+    options->profile = 0;
+    options->profileCsv = NULL;
+    options->profileTrace = NULL;
+    options->workers = default_workers();
+    options->sync = 0;
+    options->pace = PACE_CAPPED;
+    options->maxFps = DEFAULT_MAX_FPS;
+    init_headless_config(&options->headlessConfig);
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        int hasValue = i + 1 < argc;
+        if (strcmp(arg, "--headless") == 0) {
+            options->headless = 1;
+        } else if (strcmp(arg, "--ticks") == 0 && hasValue) {
+            options->headlessConfig.ticks = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--seed") == 0 && hasValue) {
+            options->headlessConfig.seed = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--record") == 0 && hasValue) {
+            options->recordPath = argv[++i];
+        } else if (strcmp(arg, "--replay") == 0 && hasValue) {
+            options->replayPath = argv[++i];
+        } else if (strcmp(arg, "--profile") == 0) {
+            options->profile = 1;
+        } else if (strcmp(arg, "--profile-csv") == 0 && hasValue) {
+            options->profileCsv = argv[++i];
+        } else if (strcmp(arg, "--profile-trace") == 0 && hasValue) {
+            options->profileTrace = argv[++i];
+        } else if (strcmp(arg, "--sync") == 0) {
+            options->sync = 1;
+        } else if (strcmp(arg, "--workers") == 0 && hasValue) {
+            options->workers = atoi(argv[++i]);
+            if (options->workers < 0) {
+                fprintf(stderr, "Worker count can not be negative!\n");
+                return GAME_ERROR;
+            }
+        } else if (strcmp(arg, "--pace") == 0 && hasValue) {
+            const char* mode = argv[++i];
+            if (!parse_pace_mode(mode, &options->pace)) {
+                fprintf(stderr, "Unknown pace mode %s!\n", mode);
+                return GAME_ERROR;
+            }
+        } else if (strcmp(arg, "--fps") == 0 && hasValue) {
+            options->maxFps = atoi(argv[++i]);
+            if (options->maxFps <= 0) {
+                fprintf(stderr, "Frame cap must be positive!\n");
+                return GAME_ERROR;
+            }
+        } else if (strcmp(arg, "--tick-rate") == 0 && hasValue) {
+            options->tickRate = atoi(argv[++i]);
+            if (options->tickRate < MIN_TICK_RATE) {
+                fprintf(stderr, "Tick rate must be at least %d!\n",
+                        MIN_TICK_RATE);
+                return GAME_ERROR;
+            }
+        } else {
+            fprintf(stderr,
+                    "Usage: %s [--headless] [--ticks N] [--seed N] "
+                    "[--tick-rate HZ] [--record FILE] [--replay FILE] "
+                    "[--profile] [--profile-csv FILE] [--profile-trace FILE] "
+                    "[--workers N] [--sync] [--pace capped|vsync|uncapped] "
+                    "[--fps N]\n",
+                    argv[0]);
+            return GAME_ERROR;
+        }
+    }
+    options->headlessConfig.deltaTime = 1.0f / options->tickRate;
+    options->headlessConfig.workers = options->workers;
     return OK;
 }
 
+// Replays always run headless, taking the seed and tick length from the
+// file so the original session is reproduced exactly
+int run_headless_main(const Options* options) {
+    HeadlessConfig config = options->headlessConfig;
+    if (options->replayPath) {
+        config.replay = open_replay_reader(options->replayPath);
+        if (!config.replay) {
+            return GAME_ERROR;
+        }
+        config.seed = config.replay->header.seed;
+        config.deltaTime = config.replay->header.deltaTime;
+    }
+
+    if (options->recordPath) {
+        ReplayHeader header = {config.seed, config.deltaTime};
+        config.record = open_replay_writer(options->recordPath, &header);
+        if (!config.record) {
+            close_replay_reader(config.replay);
+            return GAME_ERROR;
+        }
+    }
+
+    if (options->profileCsv || options->profileTrace) {
+        config.profiler =
+            init_profiler(options->profileCsv, options->profileTrace);
+        if (!config.profiler) {
+            close_replay_writer(config.record);
+            close_replay_reader(config.replay);
+            return GAME_ERROR;
+        }
+    }
+
+    HeadlessStats stats;
+    int status = run_headless(&config, &stats);
+    if (status == OK) {
+        print_headless_stats(stdout, &stats);
+    }
+    free_profiler(config.profiler);
+    close_replay_writer(config.record);
+    close_replay_reader(config.replay);
+    return status;
+}
+
 Time* init_time() {
     Time* time = (Time*)malloc(sizeof(Time));
     time->time = 0;
     time->frames = 0;
     time->lastFrame = 0;
+    time->lastSecond = 0;
+    time->fps = 0;
     time->deltaTime = 0;
     return time;
 }
 
+// Frame bookkeeping only, the simulation clock is advanced per tick in
+// update() so physics never sees the frame time
 void update_time(Time* time) {
-    // Calculate delta time and keep physics consistent
-    time->time = SDL_GetTicks();
-    time->deltaTime = (time->time - time->lastFrame) / MS_TO_SECONDS_F;
-    time->lastFrame = time->time;
+    time->lastFrame = SDL_GetTicks();
     time->frames++;
-    if (time->deltaTime < 0) {
-        time->deltaTime = 0;
-    }
-    if (time->time - time->lastSecond >= MS_TO_SECONDS) {
-        time->lastSecond = time->time;
+    if (time->lastFrame - time->lastSecond >= MS_TO_SECONDS) {
+        time->lastSecond = time->lastFrame;
         time->fps = time->frames;
         time->frames = 0;
     }
 }
 
-void limit_fps(Time* time) {
-    time->frameTime = SDL_GetTicks() - time->time;
-    if (time->frameTime < TICK_PER_FRAME) {
-        SDL_Delay(TICK_PER_FRAME - time->frameTime);
+// Frames drawn in the last second, next to the profiler overlay
+void show_fps(Window* window, const Time* time, const Profiler* profiler) {
+    int overlay = profiler && profiler->overlay;
+    set_hud_value(&window->hud, HUD_FPS, overlay ? time->fps : HUD_HIDDEN);
+}
+
+// What the frame had to deal with, recorded next to its timings
+void count_frame(const Window* window, const State* state, Uint64* pairTests,
+                 ProfileCounters* counters) {
+    counters->asteroids = state->asteroids.count;
+    counters->projectiles =
+        state->projectiles.count + state->alienProjs.count;
+    counters->pairTests = state->pairTests - *pairTests;
+    counters->drawCalls = window->batch.drawCalls;
+    *pairTests = state->pairTests;
+}
+
+// Mean and spread of the frame interval over the whole session
+void report_pacing(const FramePacer* pacer) {
+    const PaceStats* stats = &pacer->stats;
+    if (stats->frames == 0) {
+        return;
     }
+    printf("Frames: %llu, %s, mean %.3f ms, stddev %.3f ms, "
+           "min %.3f ms, max %.3f ms\n",
+           (unsigned long long)stats->frames, pace_mode_name(pacer->mode),
+           stats->mean, sqrt(pace_variance(stats)), stats->min, stats->max);
 }
 
-Window* init_window(const int width, const int height, const char* title) {
+Window* init_window(const int width, const int height, const char* title,
+                    PaceMode pace, int maxFps) {
     Window* window = (Window*)malloc(sizeof(Window));
     window->height = height;
     window->width = width;
@@ -393,15 +558,30 @@ Window* init_window(const int width, const int height, const char* title) {
         exit(WINDOW_ERROR);
     }
 
-    window->renderer =
-        SDL_CreateRenderer(window->window, -1, SDL_RENDERER_ACCELERATED);
+    Uint32 flags = SDL_RENDERER_ACCELERATED;
+    if (pace == PACE_VSYNC) {
+        flags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+    window->renderer = SDL_CreateRenderer(window->window, -1, flags);
     if (window->renderer == NULL) {
         SDL_DestroyWindow(window->window);
         free(window);
         exit(WINDOW_ERROR);
     }
 
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+    if (!init_render_batch(&window->batch, window->renderer)) {
+        fprintf(stderr, "Failed to allocate render batch!\n");
+        SDL_DestroyRenderer(window->renderer);
+        SDL_DestroyWindow(window->window);
+        free(window);
+        exit(WINDOW_ERROR);
+    }
+
+    init_hud(&window->hud);
+    init_pacer(&window->pacer, pace, maxFps);
+
+    if (Mix_OpenAudio(ASSET_FREQUENCY, ASSET_FORMAT, ASSET_CHANNELS,
+                      MIX_BUFFER_SAMPLES) < 0) {
         fprintf(stderr, "SDL_mixer could not be initialize!\n");
         free(window);
         exit(WINDOW_ERROR);
@@ -422,6 +602,7 @@ void close_window(Window* window) {
         SDL_DestroyWindow(window->window);
     }
 
+    free_render_batch(&window->batch);
     if (window->renderer) {
         SDL_DestroyRenderer(window->renderer);
     }
@@ -429,69 +610,69 @@ void close_window(Window* window) {
     SDL_Quit();
 }
 
-void update(Window* window, State* state, Time* gameTime) {
-    SDL_Event event;
+void init_fixed_step(FixedStep* step, int tickRate, int maxTicks) {
+    step->step = 1.0f / tickRate;
+    step->maxTicks = maxTicks;
+    step->tick = 0;
+    step->lastCounter = SDL_GetPerformanceCounter();
+    step->accumulator = 0;
+    step->alpha = 0;
+}
 
-    // Update logic goes here
-    float deltaTime = gameTime->deltaTime;
-    handle_events(window, &event, state->player, deltaTime);
-    update_player(state->player, deltaTime);
-    update_shoot(state, gameTime);
-    update_asteroids(state->asteroids, state->asteroidSize, deltaTime);
-    update_projectiles(state->projectiles, state->projectileSize, deltaTime);
+// Returns how many ticks to simulate for the time since the last call
+int advance_fixed_step(FixedStep* step) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    double elapsed =
+        (double)(now - step->lastCounter) / SDL_GetPerformanceFrequency();
+    step->lastCounter = now;
 
-    if (state->level >= 2 && !state->alien->hit) {
-        update_alien(state, gameTime);
+    // After a hitch or a window drag run at most maxTicks and let the
+    // rest go, rather than spiralling trying to catch up
+    step->accumulator += elapsed;
+    double maxBacklog = (double)step->step * step->maxTicks;
+    if (step->accumulator > maxBacklog) {
+        step->accumulator = maxBacklog;
     }
-    update_angle(state->alien, state->player->position);
-
-    delete_projectiles(state, gameTime->time);
-    detect_Shoot(state);
 
-    if (state->asteroidSize <= 0) {
-        state->level++;
-        spawn_asteroids(state, state->level * INIT_NUM_ASTEROIDS, time(NULL));
-        state->alien->hit = 0;
-        Mix_PlayChannel(-1, state->sounds->ran, 0);
-        state->alien->position = create_vector(0, 100);
-    }
+    int ticks = (int)(step->accumulator / step->step);
+    step->accumulator -= (double)ticks * step->step;
+    step->alpha = (float)(step->accumulator / step->step);
+    return ticks;
+}
 
-    if (!state->player->crashed) {
-        detect_crash(state, gameTime->time);
+// Sleeps until the next tick is due, less a millisecond of slack
+void wait_fixed_step(FixedStep* step) {
+    double elapsed = (double)(SDL_GetPerformanceCounter() - step->lastCounter) /
+                     SDL_GetPerformanceFrequency();
+    double left = step->step - step->accumulator - elapsed;
+    if (left > 0.002) {
+        SDL_Delay((Uint32)(left * MS_TO_SECONDS) - 1);
     }
+}
 
-    if (state->player->crashed) {
-        update_crashinfo(state->crashInfo, deltaTime);
-        if ((gameTime->time - state->player->crashTime) >= RESPAWN_TIME) {
-            respawn(state->player);
+void run_ticks(State* state, Time* gameTime, FixedStep* step, Uint8 input,
+               int ticks, ReplayWriter* record) {
+    for (int i = 0; i < ticks; i++) {
+        if (record) {
+            record_input(record, input);
         }
+        step->tick++;
+        gameTime->time = tick_time(step->tick, step->step);
+        update_state(state, input, gameTime);
     }
 }
 
-void render(Window* window, State* state, Uint32 time) {
-    SDL_SetRenderDrawColor(window->renderer, 0x00, 0x00, 0x00, 0xFF);
-    SDL_RenderClear(window->renderer);
-    draw_asteroids(window->renderer, state->asteroids, state->asteroidSize);
-    draw_projectiles(window->renderer, state->projectiles,
-                     state->projectileSize);
-    draw_projectiles(window->renderer, state->alienProjs, state->alienProjSize);
-    draw_score(window->renderer, state->score);
-
-    if (!state->alien->hit) {
-        draw_alien(window->renderer, state->alien);
-    }
-    if (!state->player->crashed) {
-        draw_player(window->renderer, state->player, time);
-    }
-
-    if (state->player->crashed) {
-        draw_crashinfo(window->renderer, state->crashInfo);
-    }
-    SDL_RenderPresent(window->renderer);
+void update(Window* window, State* state, Time* gameTime, FixedStep* step,
+            ReplayWriter* record) {
+    SDL_Event event;
+    Uint64 start = profile_begin(state->profiler, PHASE_EVENTS);
+    Uint8 input = handle_events(window, &event, state->profiler);
+    profile_end(state->profiler, PHASE_EVENTS, start);
+    int ticks = advance_fixed_step(step);
+    run_ticks(state, gameTime, step, input, ticks, record);
 }
 
-void handle_events(Window* window, SDL_Event* event, Player* player,
-                   float deltaTime) {
+Uint8 handle_events(Window* window, SDL_Event* event, Profiler* profiler) {
     while (SDL_PollEvent(event)) {
         switch (event->type) {
         case SDL_QUIT:
@@ -502,6 +683,9 @@ void handle_events(Window* window, SDL_Event* event, Player* player,
             if (event->key.keysym.sym == SDLK_ESCAPE) {
                 window->quit = 1;
             }
+            if (event->key.keysym.sym == SDLK_F3 && profiler) {
+                profiler->overlay = !profiler->overlay;
+            }
             break;
         case SDL_WINDOWEVENT:
             if (event->window.event == SDL_WINDOWEVENT_RESIZED) {
@@ -512,793 +696,19 @@ void handle_events(Window* window, SDL_Event* event, Player* player,
         }
     }
 
-    if (!player->crashed) {
-        const Uint8* state = SDL_GetKeyboardState(NULL);
-        // Forward movement/thrusters
-        if (state[SDL_SCANCODE_UP]) {
-            float dX = cos(player->rotation) * -PLAYER_SPEED * deltaTime;
-            float dY = sin(player->rotation) * -PLAYER_SPEED * deltaTime;
-            Vector2 movement = create_vector(dX, dY);
-            player->moving = 1;
-            player->velocity = vector_sum(player->velocity, movement);
-        } else {
-            player->moving = 0; // Set the moving flag back to 0
-        }
-
-        // Rotation left
-        if (state[SDL_SCANCODE_LEFT]) {
-            player->rotation -= PLAYER_ROTATION_RATE * deltaTime;
-        }
-
-        // Rotation right
-        if (state[SDL_SCANCODE_RIGHT]) {
-            player->rotation += PLAYER_ROTATION_RATE * deltaTime;
-        }
-
-        if (state[SDL_SCANCODE_SPACE]) {
-            player->shoot = 1;
-        }
+    Uint8 input = 0;
+    const Uint8* state = SDL_GetKeyboardState(NULL);
+    if (state[SDL_SCANCODE_UP]) {
+        input |= INPUT_THRUST;
     }
-}
-
-Player* init_ship(const float x, const float y) {
-    Player* player = (Player*)malloc(sizeof(Player));
-    player->moving = 0;
-    player->shoot = 0;
-    player->crashed = 0;
-    player->crashTime = 0;
-    player->position = (Vector2){x, y};
-    player->velocity = (Vector2){0, 0};
-    player->rotation = VERTICLE;
-    player->lastShot = 0;
-    return player;
-}
-
-State* init_state(void) {
-    State* state = (State*)malloc(sizeof(State));
-    if (!state) {
-        fprintf(stderr, "Failed to allocate game state!\n");
-        return NULL;
-    }
-
-    state->score = 0;
-    state->level = 1;
-    state->player = init_ship(SCREEN_WIDTH / 2.0, SCREEN_HEIGHT / 2.0);
-    if (!state->player) {
-        fprintf(stderr, "Failed to initialize player!\n");
-        free(state);
-        return NULL;
-    }
-
-    state->alien = init_alien();
-    if (!state->alien) {
-        fprintf(stderr, "Failed to initialize alien!\n");
-        free(state);
-        return NULL;
-    }
-
-    state->asteroidSize = 0;
-    state->asteroidCapacity = INIT_CAPACITY;
-    state->asteroids = (Asteroid**)malloc(sizeof(Asteroid*) * INIT_CAPACITY);
-    if (!state->asteroids) {
-        fprintf(stderr, "Failed to allocate asteroids array!\n");
-        free_player(state->player);
-        free(state);
-        return NULL;
-    }
-
-    state->crashInfo = init_crashinfo();
-    if (!state->crashInfo) {
-        fprintf(stderr, "Failed to initialize crash info!\n");
-        free(state->asteroids);
-        free_player(state->player);
-        free(state);
-        return NULL;
+    if (state[SDL_SCANCODE_LEFT]) {
+        input |= INPUT_LEFT;
     }
-
-    state->projectileSize = 0;
-    state->projectileCapacity = INIT_CAPACITY;
-    state->projectiles =
-        (Projectile**)malloc(sizeof(Projectile*) * INIT_CAPACITY);
-    if (!state->projectiles) {
-        fprintf(stderr, "Failed to allocate projectiles array!\n");
-        free_crashinfo(state->crashInfo);
-        free(state->asteroids);
-        free_player(state->player);
-        free(state);
-        return NULL;
-    }
-
-    state->alienProjSize = 0;
-    state->alienProjCapacity = INIT_CAPACITY;
-    state->alienProjs =
-        (Projectile**)malloc(sizeof(Projectile*) * INIT_CAPACITY);
-    if (!state->projectiles) {
-        fprintf(stderr, "Failed to allocate projectiles array!\n");
-        free_crashinfo(state->crashInfo);
-        free(state->asteroids);
-        free_player(state->player);
-        free(state);
-        return NULL;
+    if (state[SDL_SCANCODE_RIGHT]) {
+        input |= INPUT_RIGHT;
     }
-
-    state->sounds = init_soundmanager(EXPLOSION_PATH, SHOOT_PATH, HIT_PATH,
-                                      ALIEN_PATH, RAN_PATH);
-    if (!state->sounds) {
-        fprintf(stderr, "Failed to initialize sound manager!\n");
-        free(state->projectiles);
-        free_crashinfo(state->crashInfo);
-        free(state->asteroids);
-        free_player(state->player);
-        free(state);
-        return NULL;
-    }
-
-    return state;
-}
-
-void free_player(Player* player) { free(player); }
-
-void free_state(State* state) {
-    free_player(state->player);
-    free_crashinfo(state->crashInfo);
-    free_soundmanager(state->sounds);
-    for (int i = 0; i < state->asteroidSize; i++) {
-        free(state->asteroids[i]);
+    if (state[SDL_SCANCODE_SPACE]) {
+        input |= INPUT_SHOOT;
     }
-    free(state->asteroids);
-
-    for (int i = 0; i < state->projectileSize; i++) {
-        free(state->projectiles[i]);
-    }
-    free(state->projectiles);
-
-    for (int i = 0; i < state->alienProjSize; i++) {
-        free(state->alienProjs[i]);
-    }
-    free(state->alienProjs);
-    free(state);
-}
-
-void free_crashinfo(CrashInfo* crashInfo) {
-    for (int i = 0; i < NUM_PARTICLES; i++) {
-        free(crashInfo->particles[i]);
-    }
-
-    for (int i = 0; i < NUM_LINES; i++) {
-        free(crashInfo->lines[i]);
-    }
-    free(crashInfo->particles);
-    free(crashInfo->lines);
-    free(crashInfo);
-}
-
-void update_player(Player* player, float deltaTime) {
-    // Ensure there is a constant frictional/drag on the ship
-    player->velocity =
-        vector_mul(player->velocity, (1.0f - PLAYER_DRAG * deltaTime));
-
-    float newX = player->position.x + player->velocity.x * deltaTime;
-    float newY = player->position.y + player->velocity.y * deltaTime;
-    newX = fmod(newX + SCREEN_WIDTH, SCREEN_WIDTH);
-    newY = fmod(newY + SCREEN_HEIGHT, SCREEN_HEIGHT);
-
-    player->position = create_vector(newX, newY);
-}
-
-void draw_player(SDL_Renderer* renderer, Player* player, Uint32 time) {
-    Vector2 ship[NUM_SHIP_POINTS];
-    for (int i = 0; i < NUM_SHIP_POINTS; i++) {
-        Vector2 pos = vector_sum(player->position, INIT_SHIP_SHAPE[i]);
-        ship[i] =
-            vector_aro(pos, player->position, (player->rotation - (M_PI / 2)));
-    }
-
-    Vector2 flame[NUM_FLAME_POINTS];
-    for (int i = 0; i < NUM_FLAME_POINTS; i++) {
-        Vector2 pos = vector_sum(player->position, INIT_FLAME_SHAPE[i]);
-        flame[i] =
-            vector_aro(pos, player->position, (player->rotation - (M_PI / 2)));
-    }
-
-    draw_shape(renderer, ship, NUM_SHIP_POINTS);
-    if (player->moving && ((time % FLICKER_RATE) == 0)) {
-        draw_shape(renderer, flame, NUM_FLAME_POINTS);
-    }
-}
-
-float rand_float(float min, float max) {
-    return min + (max - min) * ((float)rand() / RAND_MAX);
-}
-
-void update_asteroid(Asteroid* asteroid, float deltaTime) {
-    float newX = asteroid->position.x + asteroid->velocity.x * deltaTime;
-    float newY = asteroid->position.y + asteroid->velocity.y * deltaTime;
-    newX = fmod(newX + SCREEN_WIDTH, SCREEN_WIDTH);
-    newY = fmod(newY + SCREEN_HEIGHT, SCREEN_HEIGHT);
-
-    asteroid->position = create_vector(newX, newY);
-}
-
-void add_asteroid(State* state, Asteroid* asteroid) {
-    if (state->asteroidSize == state->asteroidCapacity - 1) {
-        state->asteroidCapacity *= 2;
-        state->asteroids = (Asteroid**)realloc(
-            state->asteroids, sizeof(Asteroid*) * state->asteroidCapacity);
-    }
-    state->asteroids[state->asteroidSize++] = asteroid;
-}
-
-Asteroid* init_asteroid(AsteroidSize size, Vector2 position, Uint32 seed) {
-    Asteroid* asteroid = (Asteroid*)malloc(sizeof(Asteroid));
-    asteroid->size = size;
-    asteroid->seed = seed;
-    asteroid->position = position;
-
-    int idx = asteroid_size_idx(size);
-    float speed =
-        rand_float(MIN_ASTEROID_SPEEDS[idx], MAX_ASTEROID_SPEEDS[idx]);
-    float angle = rand_float(0, (2.0f * M_PI)); // Any angle within circle
-    float dX = cos(angle) * speed;
-    float dY = sin(angle) * speed;
-    asteroid->velocity = create_vector(dX, dY);
-    return asteroid;
-}
-
-void update_asteroids(Asteroid** asteroids, int size, float deltaTime) {
-    for (int i = 0; i < size; i++) {
-        Asteroid* asteroid = asteroids[i];
-        update_asteroid(asteroid, deltaTime);
-    }
-}
-
-void draw_asteroids(SDL_Renderer* renderer, Asteroid** asteroids, int size) {
-    for (int i = 0; i < size; i++) {
-        Asteroid* asteroid = asteroids[i];
-        draw_asteroid(renderer, asteroid);
-    }
-}
-
-void draw_asteroid(SDL_Renderer* renderer, Asteroid* asteroid) {
-
-    srand(asteroid->seed); // Set the seed for the given asteroids
-    int idx = asteroid_size_idx(asteroid->size);
-    int numPoints = ASTEROID_POINTS[idx];
-    Vector2 points[numPoints];
-
-    float angleStep = (2 * M_PI) / (float)numPoints; // get the step of each
-    for (int i = 0; i < (int)numPoints; i++) {
-        float radius = ASTEROID_SIZES[idx] * rand_float(MIN_RADIUS, MAX_RADIUS);
-        float angle = angleStep * i;
-        float x = cos(angle) * radius;
-        float y = sin(angle) * radius;
-        Vector2 vector = create_vector(x, y);
-        points[i] = vector_sum(asteroid->position, vector);
-    }
-    draw_shape(renderer, points, (int)numPoints);
-}
-
-void spawn_asteroids(State* state, int num, Uint32 seed) {
-    for (int i = 0; i < num; i++) {
-        seed = rand();
-        AsteroidSize size = LARGE;
-
-        srand(seed);
-        float x = rand_float(0, SCREEN_WIDTH);
-        float y = rand_float(0, SCREEN_HEIGHT);
-        Vector2 position = create_vector(x, y);
-        Asteroid* asteroid = init_asteroid(size, position, rand());
-        add_asteroid(state, asteroid);
-    }
-}
-
-int asteroid_size_idx(AsteroidSize size) {
-    switch (size) {
-    case SMALL:
-        return 0;
-        break;
-    case MEDIUM:
-        return 1;
-        break;
-    case LARGE:
-        return 2;
-        break;
-    default:
-        break;
-    }
-    return -1;
-}
-
-Projectile* init_projectile(Vector2 position, float angle, Uint32 time) {
-    Projectile* proj = (Projectile*)malloc(sizeof(Projectile));
-    proj->spawnTime = time;
-    proj->position = position;
-
-    float dX = cos(angle) * PROJ_SPEED;
-    float dY = sin(angle) * PROJ_SPEED;
-    proj->velocity = create_vector(-dX, -dY);
-    return proj;
-}
-
-void add_projectile(State* state, Uint32 time) {
-    Player* player = state->player;
-    Projectile* proj =
-        init_projectile(player->position, player->rotation, time);
-
-    if (state->projectileSize == state->projectileCapacity - 1) {
-        state->projectileCapacity *= 2;
-        state->projectiles = (Projectile**)realloc(
-            state->projectiles,
-            sizeof(Projectile*) * state->projectileCapacity);
-    }
-    state->projectiles[state->projectileSize++] = proj;
-}
-
-void update_projectile(Projectile* proj, float deltaTime) {
-    Vector2 delta = vector_mul(proj->velocity, deltaTime);
-    proj->position = vector_sum(proj->position, delta);
-}
-
-void update_projectiles(Projectile** projectiles, int size, float deltaTime) {
-    for (int i = 0; i < size; i++) {
-        update_projectile(projectiles[i], deltaTime);
-    }
-}
-
-void player_shoot(State* state, Uint32 time) {
-    add_projectile(state, time);
-    Mix_PlayChannel(-1, state->sounds->shoot, 0);
-}
-
-void draw_projectile(SDL_Renderer* renderer, Projectile* proj) {
-    draw_thick_point(renderer, proj->position.x, proj->position.y,
-                     PROJ_THICKNESS);
-}
-
-void draw_projectiles(SDL_Renderer* renderer, Projectile** projectiles,
-                      int size) {
-    for (int i = 0; i < size; i++) {
-        draw_projectile(renderer, projectiles[i]);
-    }
-}
-
-void delete_projectiles(State* state, Uint32 time) {
-    int i = 0;
-    while (i < state->projectileSize) {
-        if ((time - state->projectiles[i]->spawnTime) >= PROJ_TIME) {
-            free(state->projectiles[i]);
-            for (int j = i; j < state->projectileSize - 1; j++) {
-                state->projectiles[j] = state->projectiles[j + 1];
-            }
-            state->projectileSize--; // Reduce the count
-        } else {
-            i++; // Only move forward if no deletion occurs
-        }
-    }
-
-    i = 0;
-    while (i < state->alienProjSize) {
-        if ((time - state->alienProjs[i]->spawnTime) >= PROJ_TIME) {
-            free(state->alienProjs[i]);
-            for (int j = i; j < state->alienProjSize - 1; j++) {
-                state->alienProjs[j] = state->alienProjs[j + 1];
-            }
-            state->alienProjSize--; // Reduce the count
-        } else {
-            i++; // Only move forward if no deletion occurs
-        }
-    }
-}
-
-void update_shoot(State* state, Time* time) {
-    if (state->player->shoot &&
-        (time->time - state->player->lastShot) > FIRE_RATE) {
-        state->player->lastShot = time->time;
-        player_shoot(state, time->time);
-
-        float dX =
-            cos(state->player->rotation) * PLAYER_SHOOT_FORCE * time->deltaTime;
-        float dY =
-            sin(state->player->rotation) * PLAYER_SHOOT_FORCE * time->deltaTime;
-        Vector2 delta = create_vector(dX, dY);
-        state->player->velocity = vector_sum(state->player->velocity, delta);
-
-    } else {
-        state->player->shoot = 0;
-    }
-}
-
-// Check if a specific point is inside radius of asteroids
-// distance^2=(x−cx)^2+(y−cy)^2
-void detect_crash(State* state, Uint32 time) {
-    Vector2 position = state->player->position;
-    for (int i = 0; i < state->asteroidSize; i++) {
-        Asteroid* asteroid = state->asteroids[i];
-        float radius = asteroid->size * MAX_RADIUS;
-        float dX = position.x - asteroid->position.x;
-        float dY = position.y - asteroid->position.y;
-        if ((dX * dX + dY * dY) <= (radius * radius)) {
-            state->player->crashed = 1;
-            state->player->crashTime = time;
-            on_crash(state->crashInfo, state->player, time);
-            Mix_PlayChannel(-1, state->sounds->explosion, 0);
-        }
-    }
-
-    for (int i = 0; i < state->alienProjSize; i++) {
-        Projectile* proj = state->alienProjs[i];
-        float radius = PLAYER_SIZE;
-        float dX = proj->position.x - position.x;
-        float dY = proj->position.y - position.y;
-        if ((dX * dX + dY * dY) <= (radius * radius)) {
-            state->player->crashed = 1;
-            state->player->crashTime = time;
-            on_crash(state->crashInfo, state->player, time);
-            Mix_PlayChannel(-1, state->sounds->explosion, 0);
-        }
-    }
-}
-
-void respawn(Player* player) {
-    player->position = create_vector(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f);
-    player->crashed = 0;
-}
-
-void detect_Shoot(State* state) {
-    for (int i = 0; i < state->projectileSize; i++) {
-        Vector2 position = state->projectiles[i]->position;
-        for (int j = 0; j < state->asteroidSize; j++) {
-            Asteroid* asteroid = state->asteroids[j];
-            float radius = asteroid->size * MAX_RADIUS;
-            float dX = position.x - asteroid->position.x;
-            float dY = position.y - asteroid->position.y;
-            if ((dX * dX + dY * dY) <= (radius * radius)) {
-                Mix_PlayChannel(-1, state->sounds->hit, 0);
-                AsteroidSize size = asteroid->size;
-                Vector2 position = asteroid->position;
-                Uint32 seed = asteroid->seed;
-                free(asteroid);
-                for (int k = j; k < state->asteroidSize - 1; k++) {
-                    state->asteroids[k] = state->asteroids[k + 1];
-                }
-                state->asteroidSize--; // Reduce the count
-                j--;
-
-                on_destroy(state, size, position, seed);
-                free(state->projectiles[i]);
-                for (int l = i; l < state->projectileSize - 1; l++) {
-                    state->projectiles[l] = state->projectiles[l + 1];
-                }
-                state->projectileSize--; // Reduce the count
-                i--;
-                break;
-            }
-        }
-    }
-
-    if (!state->alien->hit) {
-        for (int i = 0; i < state->projectileSize; i++) {
-            Vector2 position = state->projectiles[i]->position;
-            Alien* alien = state->alien;
-            float radius = ALIEN_SIZE;
-            float dX = position.x - alien->position.x;
-            float dY = position.y - alien->position.y;
-            if ((dX * dX + dY * dY) <= (radius * radius)) {
-                Mix_PlayChannel(-1, state->sounds->ran, 0);
-                alien->hit = 1;
-                free(state->projectiles[i]);
-                for (int l = i; l < state->projectileSize - 1; l++) {
-                    state->projectiles[l] = state->projectiles[l + 1];
-                }
-                state->projectileSize--; // Reduce the count
-                i--;
-                break;
-            }
-        }
-    }
-}
-
-void on_destroy(State* state, AsteroidSize size, Vector2 position,
-                Uint32 seed) {
-    int idx = asteroid_size_idx(size);
-    state->score += (int)SCORES[idx];
-    if (size == MEDIUM) {
-        for (int i = 0; i < BROKEN_ASTEROID_NUM; i++) {
-            seed = rand();
-            AsteroidSize brokenSize = SMALL;
-            srand(seed);
-            Asteroid* asteroid = init_asteroid(brokenSize, position, seed);
-            add_asteroid(state, asteroid);
-        }
-    } else if (size == LARGE) {
-        for (int i = 0; i < BROKEN_ASTEROID_NUM; i++) {
-            seed = rand();
-            AsteroidSize brokenSize = MEDIUM;
-            srand(seed);
-            Asteroid* asteroid = init_asteroid(brokenSize, position, seed);
-            add_asteroid(state, asteroid);
-        }
-    }
-}
-
-void on_crash(CrashInfo* crashInfo, Player* player, Uint32 time) {
-    srand(time);
-    for (int i = 0; i < NUM_PARTICLES; i++) {
-        rand();
-        float speed = rand_float(MIN_PARTICLE_SPEED, MAX_PARTICLE_SPEED);
-        float angle = rand_float(0, (2.0f * M_PI)); // Any angle within circle
-        float dX = cos(angle) * speed;
-        float dY = sin(angle) * speed;
-        Vector2 velocity = create_vector(dX, dY);
-        Vector2 drift = vector_mul(player->velocity, DRIFT_FRACTION);
-        crashInfo->particles[i]->position = player->position;
-        crashInfo->particles[i]->velocity = vector_sum(velocity, drift);
-        crashInfo->particles[i]->spawnTime = time;
-    }
-
-    for (int i = 0; i < NUM_LINES; i++) {
-        rand();
-        float speed = rand_float(MIN_PARTICLE_SPEED, MAX_PARTICLE_SPEED);
-        float angle = rand_float(0, (2.0f * M_PI)); // Any angle within circle
-        float dir = rand_float(0, (2.0f * M_PI));   // Any angle within circle
-        float dX = cos(dir) * speed;
-        float dY = sin(dir) * speed;
-        Vector2 velocity = create_vector(dX, dY);
-        Vector2 drift = vector_mul(player->velocity, DRIFT_FRACTION);
-        crashInfo->lines[i]->position = player->position;
-        crashInfo->lines[i]->velocity = vector_sum(velocity, drift);
-        crashInfo->lines[i]->angle = angle;
-    }
-    player->velocity = create_vector(0, 0);
-}
-
-void update_crashinfo(CrashInfo* crashInfo, float deltaTime) {
-    for (int i = 0; i < NUM_PARTICLES; i++) {
-        Vector2 delta =
-            vector_mul(crashInfo->particles[i]->velocity, deltaTime);
-        Vector2 position = crashInfo->particles[i]->position;
-        crashInfo->particles[i]->position = vector_sum(position, delta);
-    }
-
-    for (int i = 0; i < NUM_LINES; i++) {
-        Vector2 delta = vector_mul(crashInfo->lines[i]->velocity, deltaTime);
-        Vector2 position = crashInfo->lines[i]->position;
-        crashInfo->lines[i]->position = vector_sum(position, delta);
-    }
-}
-
-void draw_crashinfo(SDL_Renderer* renderer, CrashInfo* crashInfo) {
-    for (int i = 0; i < NUM_PARTICLES; i++) {
-        draw_projectile(renderer, crashInfo->particles[i]);
-    }
-
-    for (int i = 0; i < NUM_LINES; i++) {
-        float angle = crashInfo->lines[i]->angle;
-        Vector2 position = crashInfo->lines[i]->position;
-
-        float x = position.x + cos(angle) * LINE_RADIUS;
-        float y = position.y + sin(angle) * LINE_RADIUS;
-        Vector2 end = create_vector(x, y);
-        draw_line(renderer, position, end);
-    }
-}
-
-CrashInfo* init_crashinfo(void) {
-    CrashInfo* crashInfo = (CrashInfo*)malloc(sizeof(CrashInfo));
-    crashInfo->particles =
-        (Projectile**)malloc(sizeof(Projectile*) * NUM_PARTICLES);
-    crashInfo->lines = (Line**)malloc(sizeof(Line*) * NUM_LINES);
-
-    for (int i = 0; i < NUM_PARTICLES; i++) {
-        crashInfo->particles[i] = (Projectile*)malloc(sizeof(Projectile));
-        crashInfo->particles[i]->spawnTime = 0;
-        crashInfo->particles[i]->position = create_vector(0, 0);
-        crashInfo->particles[i]->velocity = create_vector(0, 0);
-    }
-
-    for (int i = 0; i < NUM_LINES; i++) {
-        crashInfo->lines[i] = (Line*)malloc(sizeof(Line));
-        crashInfo->lines[i]->spawnTime = 0;
-        crashInfo->lines[i]->angle = 0;
-        crashInfo->lines[i]->position = create_vector(0, 0);
-        crashInfo->lines[i]->velocity = create_vector(0, 0);
-    }
-    return crashInfo;
-}
-
-int* get_digits(int number, int* num_digits) {
-    if (!num_digits) {
-        return NULL;
-    }
-
-    // Special case for 0
-    if (number == 0) {
-        *num_digits = 1;
-        int* digits = (int*)malloc(sizeof(int));
-        if (!digits) {
-            *num_digits = 0;
-            return NULL;
-        }
-        digits[0] = 0;
-        return digits;
-    }
-
-    int temp = number;
-    *num_digits = 0;
-    while (temp != 0) {
-        (*num_digits)++;
-        temp /= 10;
-    }
-
-    int* digits = (int*)malloc(*num_digits * sizeof(int));
-    if (!digits) {
-        *num_digits = 0;
-        return NULL;
-    }
-
-    for (int i = *num_digits - 1; i >= 0; i--) {
-        digits[i] = number % 10;
-        number /= 10;
-    }
-
-    return digits;
-}
-
-void draw_digit(SDL_Renderer* renderer, Vector2 position, int num) {
-    for (int i = 1; i < DIGIT_COUNTS[num]; i++) {
-        Vector2 a = DIGIT_POINTS[num][i - 1];
-        Vector2 b = DIGIT_POINTS[num][i];
-        Vector2 newA = vector_sum(position, a);
-        Vector2 newB = vector_sum(position, b);
-        draw_line(renderer, newA, newB);
-    }
-}
-
-void draw_score(SDL_Renderer* renderer, int score) {
-    int numDigits;
-    int* digits = get_digits(score, &numDigits);
-
-    if (!digits || numDigits <= 0) {
-        return;
-    }
-
-    float x = SCREEN_WIDTH - DIGIT_WIDTH * numDigits;
-    float y = DIGIT_HEIGHT;
-    for (int i = 0; i < numDigits; i++) {
-        Vector2 position = create_vector(x + DIGIT_WIDTH * i, y);
-        draw_digit(renderer, position, digits[i]);
-    }
-
-    free(digits);
-}
-
-void play_sound(Mix_Chunk* sound) {
-    if (sound) {
-        Mix_PlayChannel(-1, sound, 0);
-    }
-}
-
-SoundManager* init_soundmanager(const char* explosion, const char* shoot,
-                                const char* hit, const char* alien,
-                                const char* ran) {
-    if (!explosion || !shoot || !hit || !alien || !ran) {
-        fprintf(stderr, "Invalid sound file paths!\n");
-        return NULL;
-    }
-
-    SoundManager* sounds = (SoundManager*)malloc(sizeof(SoundManager));
-    if (!sounds) {
-        fprintf(stderr, "Failed to allocate sound manager!\n");
-        return NULL;
-    }
-
-    sounds->explosion = Mix_LoadWAV(explosion);
-    sounds->shoot = Mix_LoadWAV(shoot);
-    sounds->hit = Mix_LoadWAV(hit);
-    sounds->alien = Mix_LoadWAV(alien);
-    sounds->ran = Mix_LoadWAV(ran);
-
-    if (!sounds->explosion || !sounds->shoot || !sounds->hit ||
-        !sounds->alien || !sounds->ran) {
-        fprintf(stderr, "Failed to load sound effects!\n");
-        free_soundmanager(sounds);
-        return NULL;
-    }
-
-    // Set the volume to quarter of maximum
-    Mix_Volume(-1, MIX_MAX_VOLUME / 4);
-
-    return sounds;
-}
-
-void free_soundmanager(SoundManager* sounds) {
-    if (!sounds) {
-        return;
-    }
-
-    if (sounds->explosion) {
-        Mix_FreeChunk(sounds->explosion);
-    }
-
-    if (sounds->shoot) {
-        Mix_FreeChunk(sounds->shoot);
-    }
-
-    if (sounds->hit) {
-        Mix_FreeChunk(sounds->hit);
-    }
-
-    if (sounds->alien) {
-        Mix_FreeChunk(sounds->alien);
-    }
-
-    if (sounds->ran) {
-        Mix_FreeChunk(sounds->ran);
-    }
-
-    free(sounds);
-}
-
-Alien* init_alien() {
-    Alien* alien = (Alien*)malloc(sizeof(Alien));
-    alien->hit = 0;
-    alien->rotation = 0;
-    alien->lastShot = 0;
-    alien->position = create_vector(-20, 100);
-    alien->velocity = create_vector(0, 0);
-    return alien;
-}
-
-void update_angle(Alien* alien, Vector2 playerPosition) {
-    float dX = playerPosition.x - alien->position.x;
-    float dY = playerPosition.y - alien->position.y;
-
-    // atan2 returns the angle in radians between the two points
-    float angle = atan2f(-dY, -dX);
-    alien->rotation = angle;
-}
-
-void alien_shoot(State* state, Uint32 time) {
-    Alien* alien = state->alien;
-    alien->lastShot = time;
-    Projectile* proj = init_projectile(alien->position, alien->rotation, time);
-    if (state->alienProjSize == state->alienProjCapacity - 1) {
-        state->alienProjCapacity *= 2;
-        state->alienProjs = (Projectile**)realloc(
-            state->alienProjs, sizeof(Projectile*) * state->alienProjCapacity);
-    }
-    state->alienProjs[state->alienProjSize++] = proj;
-}
-
-void update_alien(State* state, Time* time) {
-    Alien* alien = state->alien;
-    Player* player = state->player;
-
-    float dX = player->position.x - alien->position.x;
-    float direction = (dX > 0) ? 1.0f : -1.0f;
-    float deltaX = direction * ALIEN_SPEED * time->deltaTime;
-
-    if (fabs(dX) > 1.0f) {
-        alien->position =
-            create_vector(alien->position.x + deltaX, alien->position.y);
-    }
-
-    if ((time->time - alien->lastShot) >= ALIEN_FIRE_RATE &&
-        !state->player->crashed &&
-        (time->time - state->player->crashTime) >=
-            RESPAWN_TIME + PLAYER_SAFE_TIME) {
-        alien_shoot(state, time->time);
-    }
-    update_projectiles(state->alienProjs, state->alienProjSize,
-                       time->deltaTime);
-}
-
-void draw_alien(SDL_Renderer* renderer, Alien* alien) {
-    Vector2 ship[NUM_ALIEN_POINTS];
-    for (int i = 0; i < NUM_ALIEN_POINTS; i++) {
-        Vector2 pos = vector_sum(alien->position, INIT_ALIEN_SHAPE[i]);
-        ship[i] = pos;
-    }
-
-    draw_shape(renderer, ship, NUM_ALIEN_POINTS);
+    return input;
 }
@@ -0,0 +1,92 @@
+#include "pacer.h"
+#include <SDL2/SDL_timer.h>
+#include <string.h>
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+const char* const PACE_MODE_NAMES[NUM_PACE_MODES] = {
+    "capped",
+    "vsync",
+    "uncapped",
+};
+
+// SDL_Delay() can overshoot by a scheduler tick, the margin covers that
+const double PACE_SPIN_SECONDS = 0.002;
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+void init_pacer(FramePacer* pacer, PaceMode mode, int fps) {
+    pacer->mode = mode;
+    pacer->frequency = SDL_GetPerformanceFrequency();
+    pacer->period = fps > 0 ? pacer->frequency / fps : 0;
+    pacer->spin = (Uint64)(pacer->frequency * PACE_SPIN_SECONDS);
+    pacer->deadline = 0;
+    pacer->lastFrame = 0;
+    memset(&pacer->stats, 0, sizeof(PaceStats));
+}
+
+static void record_frame(PaceStats* stats, double ms) {
+    stats->frames++;
+    double delta = ms - stats->mean;
+    stats->mean += delta / stats->frames;
+    stats->m2 += delta * (ms - stats->mean);
+    if (stats->frames == 1 || ms < stats->min) {
+        stats->min = ms;
+    }
+    if (ms > stats->max) {
+        stats->max = ms;
+    }
+}
+
+// Coarse sleeps in whole milliseconds while the deadline is far, then a
+// spin on the counter for the last stretch
+static Uint64 wait_until(const FramePacer* pacer, Uint64 deadline) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    while (now + pacer->spin < deadline) {
+        Uint64 ms = (deadline - now - pacer->spin) * 1000 / pacer->frequency;
+        SDL_Delay(ms > 0 ? (Uint32)ms : 1);
+        now = SDL_GetPerformanceCounter();
+    }
+    while (now < deadline) {
+        now = SDL_GetPerformanceCounter();
+    }
+    return now;
+}
+
+// Called once per frame after presenting. Deadlines advance by whole
+// periods so the rate holds on average. A frame or a wake up that runs
+// later than the spin margin restarts the schedule from now instead, as
+// catching up would mean a run of short frames right after a long one.
+void pace_frame(FramePacer* pacer) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (pacer->mode == PACE_CAPPED && pacer->period > 0) {
+        Uint64 next = pacer->deadline + pacer->period;
+        if (pacer->deadline != 0 && now < next) {
+            now = wait_until(pacer, next);
+        }
+        pacer->deadline = now > next + pacer->spin ? now : next;
+    }
+
+    if (pacer->lastFrame != 0) {
+        double ms = (double)(now - pacer->lastFrame) * 1000 / pacer->frequency;
+        record_frame(&pacer->stats, ms);
+    }
+    pacer->lastFrame = now;
+}
+
+// Of the frame interval, in milliseconds squared
+double pace_variance(const PaceStats* stats) {
+    return stats->frames > 1 ? stats->m2 / (stats->frames - 1) : 0.0;
+}
+
+int parse_pace_mode(const char* name, PaceMode* mode) {
+    for (int i = 0; i < NUM_PACE_MODES; i++) {
+        if (strcmp(name, PACE_MODE_NAMES[i]) == 0) {
+            *mode = (PaceMode)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+const char* pace_mode_name(PaceMode mode) { return PACE_MODE_NAMES[mode]; }
@@ -0,0 +1,44 @@
+#ifndef PACER_H
+#define PACER_H
+
+#include <SDL2/SDL_stdinc.h>
+
+// How the main loop waits between frames. With vsync the present call
+// blocks on the display and the pacer only measures.
+typedef enum {
+    PACE_CAPPED,
+    PACE_VSYNC,
+    PACE_UNCAPPED,
+    NUM_PACE_MODES,
+} PaceMode;
+
+// Frame intervals seen since init_pacer(), in milliseconds. Variance is
+// kept with Welford's update so a long session loses no precision.
+typedef struct {
+    Uint64 frames;
+    double mean;
+    double m2; // sum of squared differences from the mean
+    double min;
+    double max;
+} PaceStats;
+
+// Waits out each frame against an absolute deadline on the performance
+// counter, sleeping while more than the spin margin is left and spinning
+// through the rest, so the cap holds to well under a millisecond
+typedef struct {
+    PaceMode mode;
+    Uint64 frequency;
+    Uint64 period;   // counter ticks per frame when capped
+    Uint64 spin;     // counter ticks before the deadline to stop sleeping
+    Uint64 deadline; // when the current frame ends, 0 before the first
+    Uint64 lastFrame;
+    PaceStats stats;
+} FramePacer;
+
+void init_pacer(FramePacer* pacer, PaceMode mode, int fps);
+void pace_frame(FramePacer* pacer);
+double pace_variance(const PaceStats* stats);
+int parse_pace_mode(const char* name, PaceMode* mode);
+const char* pace_mode_name(PaceMode mode);
+
+#endif
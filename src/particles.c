@@ -0,0 +1,125 @@
+#include "particles.h"
+#include "integrate.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+const int PARTICLE_MASK = PARTICLE_CAPACITY - 1;
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+int init_particles(ParticleSystem* particles) {
+    particles->tail = 0;
+    particles->count = 0;
+    float** columns[] = {&particles->x,  &particles->y,  &particles->px,
+                         &particles->py, &particles->vx, &particles->vy,
+                         &particles->ex, &particles->ey, &particles->life};
+    int numColumns = sizeof(columns) / sizeof(columns[0]);
+    for (int i = 0; i < numColumns; i++) {
+        *columns[i] = (float*)malloc(sizeof(float) * PARTICLE_CAPACITY);
+    }
+    for (int i = 0; i < numColumns; i++) {
+        if (!*columns[i]) {
+            fprintf(stderr, "Failed to allocate particles!\n");
+            free_particles(particles);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void free_particles(ParticleSystem* particles) {
+    free(particles->x);
+    free(particles->y);
+    free(particles->px);
+    free(particles->py);
+    free(particles->vx);
+    free(particles->vy);
+    free(particles->ex);
+    free(particles->ey);
+    free(particles->life);
+    memset(particles, 0, sizeof(ParticleSystem));
+}
+
+void clear_particles(ParticleSystem* particles) {
+    particles->tail = 0;
+    particles->count = 0;
+}
+
+int resize_particles(ParticleSystem* particles, int count) {
+    if (count < 0 || count > PARTICLE_CAPACITY) {
+        return 0;
+    }
+    particles->tail = 0;
+    particles->count = count;
+    return 1;
+}
+
+void emit_particles(ParticleSystem* particles, const Emitter* emitter,
+                    Vector2 position, Vector2 velocity, Rng* rng) {
+    float driftX = velocity.x * emitter->drift;
+    float driftY = velocity.y * emitter->drift;
+    for (int n = 0; n < emitter->count; n++) {
+        int i;
+        if (particles->count == PARTICLE_CAPACITY) {
+            i = particles->tail; // full, the oldest makes way
+            particles->tail = (particles->tail + 1) & PARTICLE_MASK;
+        } else {
+            i = (particles->tail + particles->count++) & PARTICLE_MASK;
+        }
+
+        float speed = rng_float(rng, emitter->minSpeed, emitter->maxSpeed);
+        float direction = rng_float(rng, 0, (2.0f * M_PI));
+        particles->x[i] = position.x;
+        particles->y[i] = position.y;
+        particles->px[i] = position.x;
+        particles->py[i] = position.y;
+        particles->vx[i] = cosf(direction) * speed + driftX;
+        particles->vy[i] = sinf(direction) * speed + driftY;
+        particles->life[i] = emitter->lifetime;
+
+        // Debris keeps the angle it was thrown at, so the line end is
+        // worked out once here rather than every frame
+        particles->ex[i] = 0;
+        particles->ey[i] = 0;
+        if (emitter->length > 0) {
+            float angle = rng_float(rng, 0, (2.0f * M_PI));
+            particles->ex[i] = cosf(angle) * emitter->length;
+            particles->ey[i] = sinf(angle) * emitter->length;
+        }
+    }
+}
+
+static void update_run(ParticleSystem* particles, int begin, int count,
+                       float deltaTime) {
+    if (count <= 0) {
+        return;
+    }
+    size_t size = sizeof(float) * count;
+    memcpy(&particles->px[begin], &particles->x[begin], size);
+    memcpy(&particles->py[begin], &particles->y[begin], size);
+    integrate(&particles->x[begin], &particles->y[begin],
+              &particles->vx[begin], &particles->vy[begin], count,
+              deltaTime);
+    float* life = &particles->life[begin];
+    for (int i = 0; i < count; i++) {
+        life[i] -= deltaTime;
+    }
+}
+
+// Saves the start positions for rendering as save_previous() does for the
+// other entities, moves every particle with the integrate kernels, then
+// releases the tail for as long as it has run out
+void update_particles(ParticleSystem* particles, float deltaTime) {
+    int first = particle_first_run(particles);
+    update_run(particles, particles->tail, first, deltaTime);
+    update_run(particles, 0, particles->count - first, deltaTime);
+
+    while (particles->count > 0 && particles->life[particles->tail] <= 0) {
+        particles->tail = (particles->tail + 1) & PARTICLE_MASK;
+        particles->count--;
+    }
+}
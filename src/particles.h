@@ -0,0 +1,56 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "rng.h"
+#include "vec.h"
+#include <SDL2/SDL_stdinc.h>
+
+#define PARTICLE_CAPACITY 131072 // ring size, a power of two
+
+// A burst of particles thrown out from a point in random directions
+typedef struct {
+    int count;
+    float minSpeed;
+    float maxSpeed;
+    float drift;    // fraction of the source's velocity carried along
+    float length;   // of each debris line, 0 for dots
+    float lifetime; // seconds
+} Emitter;
+
+// Purely cosmetic particles in a ring of parallel columns, reserved once in
+// init_particles(). Live particles are [tail, tail + count) modulo the
+// capacity. Bursts are written at the head and overwrite the oldest once
+// the ring is full. Lifetimes count down each update and the tail is
+// released as it runs out, a particle that dies behind a longer lived one
+// is skipped until the tail reaches it.
+typedef struct {
+    int tail;
+    int count;
+    float* x;
+    float* y;
+    float* px; // position at the start of the current tick, for rendering
+    float* py;
+    float* vx;
+    float* vy;
+    float* ex; // end of a debris line relative to the particle, 0 for dots
+    float* ey;
+    float* life; // seconds left
+} ParticleSystem;
+
+int init_particles(ParticleSystem* particles);
+void free_particles(ParticleSystem* particles);
+void clear_particles(ParticleSystem* particles);
+// Empties the ring and makes [0, count) live for a bulk load
+int resize_particles(ParticleSystem* particles, int count);
+void emit_particles(ParticleSystem* particles, const Emitter* emitter,
+                    Vector2 position, Vector2 velocity, Rng* rng);
+void update_particles(ParticleSystem* particles, float deltaTime);
+
+// The live particles are at most two runs of the columns, this many from
+// the tail and then the rest from index 0
+static inline int particle_first_run(const ParticleSystem* particles) {
+    int room = PARTICLE_CAPACITY - particles->tail;
+    return particles->count < room ? particles->count : room;
+}
+
+#endif
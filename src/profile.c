@@ -0,0 +1,229 @@
+#include "profile.h"
+#include <SDL2/SDL_timer.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+static const char* const PHASE_NAMES[NUM_PHASES] = {
+    "events", "player",    "asteroids", "projectiles", "alien",   "shots",
+    "crash",  "particles", "render",    "present",     "delay",
+};
+
+static const double SECONDS_TO_MS = 1000.0;
+static const double SECONDS_TO_US = 1000000.0;
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+const char* phase_name(ProfilePhase phase) { return PHASE_NAMES[phase]; }
+
+static FILE* open_export(const char* path) {
+    if (!path) {
+        return NULL;
+    }
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Failed to open profile export %s!\n", path);
+    }
+    return file;
+}
+
+Profiler* init_profiler(const char* csvPath, const char* tracePath) {
+    Profiler* profiler = (Profiler*)calloc(1, sizeof(Profiler));
+    if (!profiler) {
+        fprintf(stderr, "Failed to allocate profiler!\n");
+        return NULL;
+    }
+    SDL_AtomicSet(&profiler->head, 0);
+    profiler->frequency = SDL_GetPerformanceFrequency();
+    profiler->origin = SDL_GetPerformanceCounter();
+    profiler->overlay = 1;
+
+    profiler->csv = open_export(csvPath);
+    profiler->trace = open_export(tracePath);
+    if ((csvPath && !profiler->csv) || (tracePath && !profiler->trace)) {
+        free_profiler(profiler);
+        return NULL;
+    }
+
+    if (profiler->csv) {
+        fprintf(profiler->csv, "frame,start_ms,frame_ms");
+        for (int i = 0; i < NUM_PHASES; i++) {
+            fprintf(profiler->csv, ",%s_ms", PHASE_NAMES[i]);
+        }
+        fprintf(profiler->csv, ",asteroids,projectiles,pair_tests,"
+                               "draw_calls\n");
+    }
+    if (profiler->trace) {
+        fprintf(profiler->trace, "[\n");
+    }
+    return profiler;
+}
+
+void free_profiler(Profiler* profiler) {
+    if (!profiler) {
+        return;
+    }
+
+    export_frames(profiler);
+    if (profiler->csv) {
+        fclose(profiler->csv);
+    }
+    if (profiler->trace) {
+        fprintf(profiler->trace, "\n]\n");
+        fclose(profiler->trace);
+    }
+    free(profiler);
+}
+
+void begin_frame(Profiler* profiler) {
+    if (!profiler) {
+        return;
+    }
+    FrameProfile* frame = &profiler->current;
+    Uint64 number = frame->frame + 1;
+    memset(frame, 0, sizeof(FrameProfile));
+    frame->frame = number;
+    frame->start = SDL_GetPerformanceCounter();
+}
+
+// Pair with profile_end(). Both do nothing when profiler is NULL, so the
+// simulation can be timed without knowing whether anyone is listening.
+Uint64 profile_begin(Profiler* profiler, ProfilePhase phase) {
+    (void)phase;
+    return profiler ? SDL_GetPerformanceCounter() : 0;
+}
+
+void profile_end(Profiler* profiler, ProfilePhase phase, Uint64 start) {
+    if (!profiler) {
+        return;
+    }
+    FrameProfile* frame = &profiler->current;
+    if (frame->phaseStart[phase] == 0) {
+        frame->phaseStart[phase] = start;
+    }
+    frame->phaseTime[phase] += SDL_GetPerformanceCounter() - start;
+}
+
+void end_frame(Profiler* profiler, const ProfileCounters* counters) {
+    if (!profiler) {
+        return;
+    }
+    FrameProfile* frame = &profiler->current;
+    frame->end = SDL_GetPerformanceCounter();
+    frame->counters = *counters;
+
+    // Fill the slot first, then publish it by moving head past it
+    unsigned head = (unsigned)SDL_AtomicGet(&profiler->head);
+    profiler->frames[head % PROFILE_HISTORY] = *frame;
+    SDL_AtomicSet(&profiler->head, (int)(head + 1));
+}
+
+static double to_ms(const Profiler* profiler, Uint64 ticks) {
+    return ticks * SECONDS_TO_MS / profiler->frequency;
+}
+
+static double to_us(const Profiler* profiler, Uint64 ticks) {
+    return ticks * SECONDS_TO_US / profiler->frequency;
+}
+
+static void write_csv(Profiler* profiler, const FrameProfile* frame) {
+    FILE* out = profiler->csv;
+    fprintf(out, "%llu,%.3f,%.3f", (unsigned long long)frame->frame,
+            to_ms(profiler, frame->start - profiler->origin),
+            to_ms(profiler, frame->end - frame->start));
+    for (int i = 0; i < NUM_PHASES; i++) {
+        fprintf(out, ",%.3f", to_ms(profiler, frame->phaseTime[i]));
+    }
+    const ProfileCounters* counters = &frame->counters;
+    fprintf(out, ",%d,%d,%llu,%d\n", counters->asteroids,
+            counters->projectiles, (unsigned long long)counters->pairTests,
+            counters->drawCalls);
+}
+
+static void trace_event(Profiler* profiler, const char* name, Uint64 start,
+                        Uint64 duration) {
+    fprintf(profiler->trace,
+            "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+            "\"ts\":%.1f,\"dur\":%.1f}",
+            profiler->traceEvents++ ? ",\n" : "", name,
+            to_us(profiler, start - profiler->origin),
+            to_us(profiler, duration));
+}
+
+// Chrome trace JSON, loadable in chrome://tracing or Perfetto
+static void write_trace(Profiler* profiler, const FrameProfile* frame) {
+    trace_event(profiler, "frame", frame->start, frame->end - frame->start);
+    for (int i = 0; i < NUM_PHASES; i++) {
+        if (frame->phaseStart[i] != 0) {
+            trace_event(profiler, PHASE_NAMES[i], frame->phaseStart[i],
+                        frame->phaseTime[i]);
+        }
+    }
+
+    const ProfileCounters* counters = &frame->counters;
+    fprintf(profiler->trace,
+            ",\n{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"ts\":%.1f,"
+            "\"args\":{\"asteroids\":%d,\"projectiles\":%d,"
+            "\"pair_tests\":%llu,\"draw_calls\":%d}}",
+            to_us(profiler, frame->start - profiler->origin),
+            counters->asteroids, counters->projectiles,
+            (unsigned long long)counters->pairTests, counters->drawCalls);
+}
+
+// Consumer side: writes every frame published since the last call. If the
+// producer has lapped the exporters the overwritten frames are skipped.
+void export_frames(Profiler* profiler) {
+    if (!profiler || (!profiler->csv && !profiler->trace)) {
+        return;
+    }
+
+    unsigned head = (unsigned)SDL_AtomicGet(&profiler->head);
+    unsigned tail = (unsigned)profiler->tail;
+    if (head - tail > PROFILE_HISTORY) {
+        tail = head - PROFILE_HISTORY;
+    }
+    for (; tail != head; tail++) {
+        const FrameProfile* frame = &profiler->frames[tail % PROFILE_HISTORY];
+        if (profiler->csv) {
+            write_csv(profiler, frame);
+        }
+        if (profiler->trace) {
+            write_trace(profiler, frame);
+        }
+    }
+    profiler->tail = (int)tail;
+}
+
+// Copies the durations of the most recent frames, oldest first, in ms
+int recent_frame_times(const Profiler* profiler, float* out, int max) {
+    unsigned head = (unsigned)SDL_AtomicGet((SDL_atomic_t*)&profiler->head);
+    int count = head < PROFILE_HISTORY ? (int)head : PROFILE_HISTORY;
+    if (count > max) {
+        count = max;
+    }
+    for (int i = 0; i < count; i++) {
+        const FrameProfile* frame =
+            &profiler->frames[(head - count + i) % PROFILE_HISTORY];
+        out[i] = (float)to_ms(profiler, frame->end - frame->start);
+    }
+    return count;
+}
+
+static int compare_floats(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+// Frame time in ms below which the given fraction of recent frames fall
+float frame_percentile(const Profiler* profiler, float percentile) {
+    float times[PROFILE_HISTORY];
+    int count = recent_frame_times(profiler, times, PROFILE_HISTORY);
+    if (count == 0) {
+        return 0;
+    }
+    qsort(times, count, sizeof(float), compare_floats);
+    int idx = (int)(percentile * (count - 1) + 0.5f);
+    return times[idx];
+}
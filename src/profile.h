@@ -0,0 +1,70 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_stdinc.h>
+#include <stdio.h>
+
+#define PROFILE_HISTORY 512 // frames kept in the ring, a power of two
+
+typedef enum {
+    PHASE_EVENTS,
+    PHASE_PLAYER,
+    PHASE_ASTEROIDS,
+    PHASE_PROJECTILES,
+    PHASE_ALIEN,
+    PHASE_SHOTS, // detect_Shoot()
+    PHASE_CRASH, // detect_crash()
+    PHASE_PARTICLES,
+    PHASE_RENDER,
+    PHASE_PRESENT,
+    PHASE_DELAY, // waiting in pace_frame()
+    NUM_PHASES,
+} ProfilePhase;
+
+typedef struct {
+    int asteroids;
+    int projectiles;
+    Uint64 pairTests; // narrowphase tests made during the frame
+    int drawCalls;
+} ProfileCounters;
+
+// Times are in performance counter units. A phase that runs several times
+// in a frame, once per simulation tick, is summed.
+typedef struct {
+    Uint64 frame;
+    Uint64 start;
+    Uint64 end;
+    Uint64 phaseStart[NUM_PHASES]; // first entry into the phase, 0 if none
+    Uint64 phaseTime[NUM_PHASES];
+    ProfileCounters counters;
+} FrameProfile;
+
+// Single producer, single consumer ring. The game loop fills frames and
+// publishes them by advancing head; readers never take a lock and only
+// look at frames before head. Old frames are overwritten, not waited on.
+typedef struct {
+    FrameProfile frames[PROFILE_HISTORY];
+    SDL_atomic_t head; // frames published so far
+    int tail;          // next frame for the exporters, consumer side only
+    FrameProfile current;
+    Uint64 frequency;
+    Uint64 origin; // counter at init, exported times are relative to it
+    int overlay;   // draw the on-screen graph
+    FILE* csv;
+    FILE* trace;
+    int traceEvents;
+} Profiler;
+
+Profiler* init_profiler(const char* csvPath, const char* tracePath);
+void free_profiler(Profiler* profiler);
+void begin_frame(Profiler* profiler);
+Uint64 profile_begin(Profiler* profiler, ProfilePhase phase);
+void profile_end(Profiler* profiler, ProfilePhase phase, Uint64 start);
+void end_frame(Profiler* profiler, const ProfileCounters* counters);
+void export_frames(Profiler* profiler);
+int recent_frame_times(const Profiler* profiler, float* out, int max);
+float frame_percentile(const Profiler* profiler, float percentile);
+const char* phase_name(ProfilePhase phase);
+
+#endif
@@ -0,0 +1,255 @@
+#include "render.h"
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+// Ship constant
+const int NUM_SHIP_POINTS = 5;
+const Vector2 INIT_SHIP_SHAPE[] = {
+    {0, -15}, {11.25, 15}, {10.75, 11.25}, {-10.75, 11.25}, {-11.25, 15},
+};
+
+const int NUM_ALIEN_POINTS = 13;
+const Vector2 INIT_ALIEN_SHAPE[] = {
+    {-10, 30}, {10, 30}, {25, 25},  {15, 15},  {10, 15},  {10, 5},  {5, 0},
+    {-5, 0},   {-10, 5}, {-10, 15}, {-15, 15}, {-25, 25}, {-10, 30}};
+
+const int NUM_FLAME_POINTS = 3;
+const Vector2 INIT_FLAME_SHAPE[] = {
+    {9, 11.25},
+    {-9, 11.25},
+    {0, 26.25},
+};
+
+const int FLICKER_RATE = 3;
+const int PROJ_THICKNESS = 2;
+const int PARTICLE_DRAW_CHUNK = 256; // dots interpolated per batch_points()
+const int ALIEN_DRAW_CHUNK = 64;     // aliens placed per transform_shape()
+
+// Profiler overlay, a bar per frame along the bottom left of the screen
+const int GRAPH_FRAMES = 240;
+const float GRAPH_LEFT = 10.0f;
+const float GRAPH_MS_HEIGHT = 4.0f;    // pixels per millisecond of frame
+const float GRAPH_BUDGET_MS = 16.667f; // reference line, one 60 Hz frame
+const float STAT_SCALE = 0.4f;         // p50/p99 digits relative to score
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+// Blend from the start of the tick to its end. A jump of more than half the
+// screen is a wrap or a teleport, so it is drawn at the new position.
+static float lerp_coord(float prev, float current, float alpha, float size) {
+    float delta = current - prev;
+    if (fabsf(delta) > size / 2) {
+        return current;
+    }
+    return prev + delta * alpha;
+}
+
+static Vector2 lerp_position(Vector2 prev, Vector2 current, float alpha) {
+    return create_vector(lerp_coord(prev.x, current.x, alpha, SCREEN_WIDTH),
+                         lerp_coord(prev.y, current.y, alpha, SCREEN_HEIGHT));
+}
+
+// Everything is queued on the batch and reaches the driver in one flush.
+// alpha is how far the display is between the last two simulation ticks.
+// The level and fps readouts show with the profiler overlay.
+void render(RenderBatch* batch, Hud* hud, State* state, Uint32 time,
+            float alpha) {
+    Profiler* profiler = state->profiler;
+    Uint64 start = profile_begin(profiler, PHASE_RENDER);
+    int overlay = profiler && profiler->overlay;
+    set_hud_value(hud, HUD_SCORE, state->score);
+    set_hud_value(hud, HUD_LEVEL, overlay ? state->level : HUD_HIDDEN);
+
+    SDL_SetRenderDrawColor(batch->renderer, 0x00, 0x00, 0x00, 0xFF);
+    SDL_RenderClear(batch->renderer);
+    batch_color(batch, 0xFF, 0xFF, 0xFF, 0xFF);
+    draw_asteroids(batch, &state->asteroids, alpha);
+    draw_projectiles(batch, &state->projectiles, alpha);
+    draw_projectiles(batch, &state->alienProjs, alpha);
+    draw_hud(batch, hud);
+
+    draw_aliens(batch, &state->aliens, alpha);
+    if (!state->player->crashed) {
+        draw_player(batch, state->player, time, alpha);
+    }
+
+    draw_particles(batch, &state->particles, alpha);
+
+    if (profiler && profiler->overlay) {
+        draw_profile(batch, profiler);
+    }
+    profile_end(profiler, PHASE_RENDER, start);
+
+    start = profile_begin(profiler, PHASE_PRESENT);
+    flush_render_batch(batch);
+    SDL_RenderPresent(batch->renderer);
+    profile_end(profiler, PHASE_PRESENT, start);
+}
+
+void draw_player(RenderBatch* batch, Player* player, Uint32 time,
+                 float alpha) {
+    Vector2 position =
+        lerp_position(player->prevPosition, player->position, alpha);
+    float rotation = player->prevRotation +
+                     (player->rotation - player->prevRotation) * alpha;
+
+    // One rotation for the ship and its flame
+    Transform transform = create_transform(position, rotation - (M_PI / 2));
+    Vector2 ship[NUM_SHIP_POINTS];
+    Vector2 flame[NUM_FLAME_POINTS];
+    transform_shape(&transform, 1, INIT_SHIP_SHAPE, NUM_SHIP_POINTS, ship);
+    transform_shape(&transform, 1, INIT_FLAME_SHAPE, NUM_FLAME_POINTS, flame);
+
+    batch_shape(batch, ship, NUM_SHIP_POINTS);
+    if (player->moving && ((time % FLICKER_RATE) == 0)) {
+        batch_shape(batch, flame, NUM_FLAME_POINTS);
+    }
+}
+
+void draw_asteroids(RenderBatch* batch, const AsteroidArray* asteroids,
+                    float alpha) {
+    for (int i = 0; i < asteroids->count; i++) {
+        float x = lerp_coord(asteroids->px[i], asteroids->x[i], alpha,
+                             SCREEN_WIDTH);
+        float y = lerp_coord(asteroids->py[i], asteroids->y[i], alpha,
+                             SCREEN_HEIGHT);
+        Vector2 position = create_vector(x, y);
+        draw_asteroid(batch, position, &asteroids->shape[i]);
+    }
+}
+
+// The outline is cached at spawn so drawing is only a translation
+void draw_asteroid(RenderBatch* batch, Vector2 position,
+                   const AsteroidShape* shape) {
+    Vector2 points[MAX_ASTEROID_POINTS];
+    for (int i = 0; i < shape->numPoints; i++) {
+        points[i] = create_vector(position.x + shape->x[i],
+                                  position.y + shape->y[i]);
+    }
+    batch_shape(batch, points, shape->numPoints);
+}
+
+void draw_projectile(RenderBatch* batch, Vector2 position) {
+    batch_point(batch, position.x, position.y, PROJ_THICKNESS);
+}
+
+void draw_projectiles(RenderBatch* batch, const ProjectileArray* projectiles,
+                      float alpha) {
+    for (int i = 0; i < projectiles->count; i++) {
+        float x = lerp_coord(projectiles->px[i], projectiles->x[i], alpha,
+                             SCREEN_WIDTH);
+        float y = lerp_coord(projectiles->py[i], projectiles->y[i], alpha,
+                             SCREEN_HEIGHT);
+        Vector2 position = create_vector(x, y);
+        draw_projectile(batch, position);
+    }
+}
+
+// Dots are interpolated a chunk at a time and queued together, debris
+// lines carry their end offset so no trigonometry runs per frame
+static void draw_particle_run(RenderBatch* batch,
+                              const ParticleSystem* particles, int begin,
+                              int count, float alpha) {
+    float dotX[PARTICLE_DRAW_CHUNK];
+    float dotY[PARTICLE_DRAW_CHUNK];
+    int numDots = 0;
+    for (int i = begin; i < begin + count; i++) {
+        if (particles->life[i] <= 0) {
+            continue; // dead behind a longer lived particle
+        }
+        float x = lerp_coord(particles->px[i], particles->x[i], alpha,
+                             SCREEN_WIDTH);
+        float y = lerp_coord(particles->py[i], particles->y[i], alpha,
+                             SCREEN_HEIGHT);
+        float eX = particles->ex[i];
+        float eY = particles->ey[i];
+        if (eX != 0 || eY != 0) {
+            batch_line(batch, create_vector(x, y),
+                       create_vector(x + eX, y + eY));
+            continue;
+        }
+
+        dotX[numDots] = x;
+        dotY[numDots++] = y;
+        if (numDots == PARTICLE_DRAW_CHUNK) {
+            batch_points(batch, dotX, dotY, numDots, PROJ_THICKNESS);
+            numDots = 0;
+        }
+    }
+    batch_points(batch, dotX, dotY, numDots, PROJ_THICKNESS);
+}
+
+void draw_particles(RenderBatch* batch, const ParticleSystem* particles,
+                    float alpha) {
+    int first = particle_first_run(particles);
+    draw_particle_run(batch, particles, particles->tail, first, alpha);
+    draw_particle_run(batch, particles, 0, particles->count - first, alpha);
+}
+
+// Left aligned at position, glyphs scaled about their centres
+void draw_number(RenderBatch* batch, Vector2 position, int number,
+                 float scale) {
+    Vector2 lines[MAX_NUMBER_LINES][2];
+    int numLines = number_lines(number, position, scale, lines);
+    for (int i = 0; i < numLines; i++) {
+        batch_line(batch, lines[i][0], lines[i][1]);
+    }
+}
+
+// Recent frame times as bars, green within the budget and red over it,
+// with the p50 and p99 frame times above them in microseconds
+void draw_profile(RenderBatch* batch, const Profiler* profiler) {
+    float times[PROFILE_HISTORY];
+    int count = recent_frame_times(profiler, times, GRAPH_FRAMES);
+    float bottom = SCREEN_HEIGHT - GRAPH_LEFT;
+    float budget = bottom - GRAPH_BUDGET_MS * GRAPH_MS_HEIGHT;
+
+    for (int i = 0; i < count; i++) {
+        float x = GRAPH_LEFT + i;
+        float top = bottom - times[i] * GRAPH_MS_HEIGHT;
+        if (times[i] > GRAPH_BUDGET_MS) {
+            batch_color(batch, 0xFF, 0x40, 0x40, 0xFF);
+        } else {
+            batch_color(batch, 0x40, 0xFF, 0x40, 0xFF);
+        }
+        batch_line(batch, create_vector(x, bottom), create_vector(x, top));
+    }
+
+    batch_color(batch, 0xFF, 0xFF, 0xFF, 0x80);
+    batch_line(batch, create_vector(GRAPH_LEFT, budget),
+               create_vector(GRAPH_LEFT + GRAPH_FRAMES, budget));
+
+    float x = GRAPH_LEFT + DIGIT_WIDTH * STAT_SCALE / 2;
+    float y = budget - DIGIT_HEIGHT * STAT_SCALE;
+    float p50 = frame_percentile(profiler, 0.5f);
+    float p99 = frame_percentile(profiler, 0.99f);
+    batch_color(batch, 0x40, 0xFF, 0x40, 0xFF);
+    draw_number(batch, create_vector(x, y), (int)(p50 * 1000), STAT_SCALE);
+    batch_color(batch, 0xFF, 0xA0, 0x40, 0xFF);
+    draw_number(batch, create_vector(x + GRAPH_FRAMES / 2.0f, y),
+                (int)(p99 * 1000), STAT_SCALE);
+    batch_color(batch, 0xFF, 0xFF, 0xFF, 0xFF);
+}
+
+// Aliens are never rotated and share one outline, so a chunk of them is
+// placed with a single transform_shape() and queued with batch_shapes()
+void draw_aliens(RenderBatch* batch, const AlienArray* aliens, float alpha) {
+    Transform transforms[ALIEN_DRAW_CHUNK];
+    Vector2 outlines[ALIEN_DRAW_CHUNK * NUM_ALIEN_POINTS];
+    for (int start = 0; start < aliens->count; start += ALIEN_DRAW_CHUNK) {
+        int count = aliens->count - start;
+        if (count > ALIEN_DRAW_CHUNK) {
+            count = ALIEN_DRAW_CHUNK;
+        }
+        for (int i = 0; i < count; i++) {
+            int a = start + i;
+            Vector2 prev = create_vector(aliens->px[a], aliens->py[a]);
+            Vector2 current = create_vector(aliens->x[a], aliens->y[a]);
+            transforms[i] =
+                create_transform(lerp_position(prev, current, alpha), 0);
+        }
+        transform_shape(transforms, count, INIT_ALIEN_SHAPE,
+                        NUM_ALIEN_POINTS, outlines);
+        batch_shapes(batch, outlines, count, NUM_ALIEN_POINTS);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "batch.h"
+#include "game.h"
+#include "hud.h"
+#include "profile.h"
+#include <SDL2/SDL_render.h>
+
+void render(RenderBatch* batch, Hud* hud, State* state, Uint32 time,
+            float alpha);
+void draw_player(RenderBatch* batch, Player* player, Uint32 time,
+                 float alpha);
+void draw_asteroid(RenderBatch* batch, Vector2 position,
+                   const AsteroidShape* shape);
+void draw_asteroids(RenderBatch* batch, const AsteroidArray* asteroids,
+                    float alpha);
+void draw_projectile(RenderBatch* batch, Vector2 position);
+void draw_projectiles(RenderBatch* batch, const ProjectileArray* projectiles,
+                      float alpha);
+void draw_particles(RenderBatch* batch, const ParticleSystem* particles,
+                    float alpha);
+void draw_number(RenderBatch* batch, Vector2 position, int number,
+                 float scale);
+void draw_profile(RenderBatch* batch, const Profiler* profiler);
+void draw_aliens(RenderBatch* batch, const AlienArray* aliens, float alpha);
+
+#endif
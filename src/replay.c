@@ -0,0 +1,160 @@
+#include "replay.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+const char REPLAY_MAGIC[4] = {'A', 'R', 'P', 'L'};
+const Uint8 REPLAY_VERSION = 1;
+const Uint8 REPLAY_INPUT_MASK = 0x0F;
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+// Fields are stored little endian whatever the host byte order
+static void write_u32(Uint8* bytes, Uint32 value) {
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = (Uint8)(value >> (8 * i));
+    }
+}
+
+static Uint32 read_u32(const Uint8* bytes) {
+    Uint32 value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (Uint32)bytes[i] << (8 * i);
+    }
+    return value;
+}
+
+ReplayWriter* open_replay_writer(const char* path, const ReplayHeader* header) {
+    ReplayWriter* writer = (ReplayWriter*)malloc(sizeof(ReplayWriter));
+    if (!writer) {
+        fprintf(stderr, "Failed to allocate replay writer!\n");
+        return NULL;
+    }
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        fprintf(stderr, "Failed to open replay file %s!\n", path);
+        free(writer);
+        return NULL;
+    }
+    writer->input = 0;
+    writer->run = 0;
+    writer->ticks = 0;
+
+    Uint32 deltaBits;
+    memcpy(&deltaBits, &header->deltaTime, sizeof(deltaBits));
+    Uint8 bytes[REPLAY_HEADER_SIZE] = {0};
+    memcpy(bytes, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    bytes[4] = REPLAY_VERSION;
+    write_u32(&bytes[8], header->seed);
+    write_u32(&bytes[12], deltaBits);
+    if (fwrite(bytes, 1, REPLAY_HEADER_SIZE, writer->file) !=
+        REPLAY_HEADER_SIZE) {
+        fprintf(stderr, "Failed to write replay header!\n");
+        fclose(writer->file);
+        free(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+static int flush_run(ReplayWriter* writer) {
+    if (writer->run == 0) {
+        return 1;
+    }
+    Uint8 record = (Uint8)(writer->input | ((writer->run - 1) << 4));
+    writer->run = 0;
+    return fputc(record, writer->file) != EOF;
+}
+
+// Held inputs collapse into one byte for up to REPLAY_MAX_RUN ticks
+int record_input(ReplayWriter* writer, Uint8 input) {
+    input &= REPLAY_INPUT_MASK;
+    writer->ticks++;
+    if (writer->run > 0 && writer->input == input &&
+        writer->run < REPLAY_MAX_RUN) {
+        writer->run++;
+        return 1;
+    }
+
+    int ok = flush_run(writer);
+    writer->input = input;
+    writer->run = 1;
+    return ok;
+}
+
+void close_replay_writer(ReplayWriter* writer) {
+    if (!writer) {
+        return;
+    }
+
+    if (!flush_run(writer) || fclose(writer->file) != 0) {
+        fprintf(stderr, "Failed to finish replay file!\n");
+    }
+    free(writer);
+}
+
+ReplayReader* open_replay_reader(const char* path) {
+    ReplayReader* reader = (ReplayReader*)malloc(sizeof(ReplayReader));
+    if (!reader) {
+        fprintf(stderr, "Failed to allocate replay reader!\n");
+        return NULL;
+    }
+
+    reader->file = fopen(path, "rb");
+    if (!reader->file) {
+        fprintf(stderr, "Failed to open replay file %s!\n", path);
+        free(reader);
+        return NULL;
+    }
+
+    Uint8 bytes[REPLAY_HEADER_SIZE];
+    if (fread(bytes, 1, REPLAY_HEADER_SIZE, reader->file) !=
+            REPLAY_HEADER_SIZE ||
+        memcmp(bytes, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0 ||
+        bytes[4] != REPLAY_VERSION) {
+        fprintf(stderr, "%s is not a supported replay file!\n", path);
+        fclose(reader->file);
+        free(reader);
+        return NULL;
+    }
+
+    Uint32 deltaBits = read_u32(&bytes[12]);
+    reader->header.seed = read_u32(&bytes[8]);
+    memcpy(&reader->header.deltaTime, &deltaBits, sizeof(deltaBits));
+    reader->length = 0;
+    reader->pos = 0;
+    reader->input = 0;
+    reader->run = 0;
+    return reader;
+}
+
+// Returns 0 once every recorded tick has been read
+int next_replay_input(ReplayReader* reader, Uint8* input) {
+    if (reader->run == 0) {
+        if (reader->pos == reader->length) {
+            reader->length = (int)fread(reader->buffer, 1, REPLAY_BUFFER_SIZE,
+                                        reader->file);
+            reader->pos = 0;
+            if (reader->length == 0) {
+                return 0;
+            }
+        }
+        Uint8 record = reader->buffer[reader->pos++];
+        reader->input = record & REPLAY_INPUT_MASK;
+        reader->run = (record >> 4) + 1;
+    }
+
+    reader->run--;
+    *input = reader->input;
+    return 1;
+}
+
+void close_replay_reader(ReplayReader* reader) {
+    if (!reader) {
+        return;
+    }
+    fclose(reader->file);
+    free(reader);
+}
@@ -0,0 +1,46 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <SDL2/SDL_stdinc.h>
+#include <stdio.h>
+
+// A replay is a 16 byte header followed by run length records. Each record
+// is one byte: the InputFlags in the low nibble and the number of ticks
+// they were held, minus one, in the high nibble. The file is only ever
+// appended to and has no offsets in it, so it can be streamed or mapped.
+#define REPLAY_HEADER_SIZE 16
+#define REPLAY_MAX_RUN 16
+#define REPLAY_BUFFER_SIZE 4096
+
+typedef struct {
+    Uint32 seed;     // passed to seed_state() before the first spawn
+    float deltaTime; // simulated seconds per tick
+} ReplayHeader;
+
+typedef struct {
+    FILE* file;
+    Uint8 input; // input of the run not yet written
+    int run;     // ticks in that run, 0 when there is none
+    Uint64 ticks;
+} ReplayWriter;
+
+// Reads through a fixed buffer so a session of any length uses the same
+// small amount of memory
+typedef struct {
+    FILE* file;
+    ReplayHeader header;
+    Uint8 buffer[REPLAY_BUFFER_SIZE];
+    int length;
+    int pos;
+    Uint8 input; // input of the current record
+    int run;     // ticks left in the current record
+} ReplayReader;
+
+ReplayWriter* open_replay_writer(const char* path, const ReplayHeader* header);
+int record_input(ReplayWriter* writer, Uint8 input);
+void close_replay_writer(ReplayWriter* writer);
+ReplayReader* open_replay_reader(const char* path);
+int next_replay_input(ReplayReader* reader, Uint8* input);
+void close_replay_reader(ReplayReader* reader);
+
+#endif
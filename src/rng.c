@@ -0,0 +1,36 @@
+#include "rng.h"
+
+const Uint64 PCG_MULTIPLIER = 6364136223846793005ULL;
+const float FLOAT_UNIT = 1.0f / 16777216.0f; // 2^-24, one float mantissa
+
+void seed_rng(Rng* rng, Uint64 seed, RngStream stream) {
+    rng->state = 0;
+    rng->inc = ((Uint64)stream << 1u) | 1u;
+    rng_next(rng);
+    rng->state += seed;
+    rng_next(rng);
+}
+
+Uint32 rng_next(Rng* rng) {
+    Uint64 old = rng->state;
+    rng->state = old * PCG_MULTIPLIER + rng->inc;
+    Uint32 xorShifted = (Uint32)(((old >> 18u) ^ old) >> 27u);
+    Uint32 rotation = (Uint32)(old >> 59u);
+    return (xorShifted >> rotation) | (xorShifted << ((-rotation) & 31));
+}
+
+// The top 24 bits scaled into [0, 1), so every value is exact
+static float unit_float(Uint32 bits) { return (bits >> 8) * FLOAT_UNIT; }
+
+// Uniform in [min, max)
+float rng_float(Rng* rng, float min, float max) {
+    return min + (max - min) * unit_float(rng_next(rng));
+}
+
+// The same values, in the same order, as count calls to rng_float()
+void rng_fill_floats(Rng* rng, float* out, int count, float min, float max) {
+    float range = max - min;
+    for (int i = 0; i < count; i++) {
+        out[i] = min + range * unit_float(rng_next(rng));
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <SDL2/SDL_stdinc.h>
+
+// Streams keep independent sequences apart even when seeded alike, so
+// cosmetic randomness can never shift gameplay
+typedef enum {
+    RNG_STREAM_GAMEPLAY = 1,
+    RNG_STREAM_COSMETIC,
+    RNG_STREAM_SHAPE,
+} RngStream;
+
+// PCG32 generator: 64 bits of state, 32 bit output. Small enough to keep
+// one per simulation and deterministic for a given seed and stream.
+typedef struct {
+    Uint64 state;
+    Uint64 inc; // stream selector, always odd
+} Rng;
+
+void seed_rng(Rng* rng, Uint64 seed, RngStream stream);
+Uint32 rng_next(Rng* rng);
+float rng_float(Rng* rng, float min, float max);
+void rng_fill_floats(Rng* rng, float* out, int count, float min, float max);
+
+#endif
@@ -0,0 +1,484 @@
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+static const char SNAPSHOT_MAGIC[4] = {'A', 'S', 'N', 'P'};
+static const Uint32 SNAPSHOT_VERSION = 5;
+static const char VIEW_MAGIC[4] = {'A', 'S', 'V', 'W'};
+static const Uint32 VIEW_VERSION = 1;
+
+/*-----------------------------------STRUCTS----------------------------------*/
+
+typedef struct {
+    char magic[4];
+    Uint32 version;
+    Uint64 size; // of the whole snapshot, header included
+    Uint64 tick; // simulation tick the snapshot was taken on
+    Uint64 pairTests;
+    int score;
+    int level;
+    int numAliens;
+    int numAsteroids;
+    int numSpawns;
+    int numProjectiles;
+    int numAlienProjs;
+    int numParticles;
+    Rng rng;
+    Rng fxRng;
+    Player player;
+} SnapshotHeader;
+
+// Only what render() and the profiler counters read, the player is small
+// enough to go whole
+typedef struct {
+    char magic[4];
+    Uint32 version;
+    Uint64 size;
+    Uint64 tick;
+    Uint64 pairTests;
+    int score;
+    int level;
+    int numAliens;
+    int numAsteroids;
+    int numProjectiles;
+    int numAlienProjs;
+    int numParticles;
+    Player player;
+} ViewHeader;
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+void init_snapshot(Snapshot* snapshot) {
+    snapshot->data = NULL;
+    snapshot->size = 0;
+    snapshot->capacity = 0;
+}
+
+void free_snapshot(Snapshot* snapshot) {
+    free(snapshot->data);
+    init_snapshot(snapshot);
+}
+
+static size_t alien_bytes(int count) {
+    return (5 * sizeof(float) + sizeof(Uint32)) * count;
+}
+
+static size_t asteroid_bytes(int count) {
+    size_t perAsteroid = 6 * sizeof(float) + sizeof(Uint32) +
+                         sizeof(AsteroidSize) + sizeof(AsteroidShape);
+    return perAsteroid * count;
+}
+
+static size_t projectile_bytes(int count) {
+    return (6 * sizeof(float) + sizeof(Uint32)) * count;
+}
+
+static size_t particle_bytes(int count) {
+    return 9 * sizeof(float) * count;
+}
+
+static size_t layout_size(int numAliens, int numAsteroids, int numSpawns,
+                          int numProjectiles, int numAlienProjs,
+                          int numParticles) {
+    return sizeof(SnapshotHeader) + alien_bytes(numAliens) +
+           asteroid_bytes(numAsteroids) + sizeof(SpawnRequest) * numSpawns +
+           projectile_bytes(numProjectiles) +
+           projectile_bytes(numAlienProjs) + particle_bytes(numParticles);
+}
+
+size_t snapshot_size(const State* state) {
+    return layout_size(state->aliens.count, state->asteroids.count,
+                       state->spawns.count,
+                       state->projectiles.count,
+                       state->alienProjs.count,
+                       state->particles.count);
+}
+
+// Empty columns may not be allocated yet, and memcpy() must not see NULL
+static Uint8* put(Uint8* out, const void* src, size_t size) {
+    if (size > 0) {
+        memcpy(out, src, size);
+    }
+    return out + size;
+}
+
+static const Uint8* get(const Uint8* in, void* dst, size_t size) {
+    if (size > 0) {
+        memcpy(dst, in, size);
+    }
+    return in + size;
+}
+
+static Uint8* put_aliens(Uint8* out, const AlienArray* aliens) {
+    size_t floats = sizeof(float) * aliens->count;
+    out = put(out, aliens->x, floats);
+    out = put(out, aliens->y, floats);
+    out = put(out, aliens->px, floats);
+    out = put(out, aliens->py, floats);
+    out = put(out, aliens->rotation, floats);
+    out = put(out, aliens->nextShot, sizeof(Uint32) * aliens->count);
+    return out;
+}
+
+static const Uint8* get_aliens(const Uint8* in, AlienArray* aliens) {
+    size_t floats = sizeof(float) * aliens->count;
+    in = get(in, aliens->x, floats);
+    in = get(in, aliens->y, floats);
+    in = get(in, aliens->px, floats);
+    in = get(in, aliens->py, floats);
+    in = get(in, aliens->rotation, floats);
+    in = get(in, aliens->nextShot, sizeof(Uint32) * aliens->count);
+    return in;
+}
+
+static Uint8* put_asteroids(Uint8* out, const AsteroidArray* asteroids) {
+    size_t floats = sizeof(float) * asteroids->count;
+    out = put(out, asteroids->x, floats);
+    out = put(out, asteroids->y, floats);
+    out = put(out, asteroids->vx, floats);
+    out = put(out, asteroids->vy, floats);
+    out = put(out, asteroids->px, floats);
+    out = put(out, asteroids->py, floats);
+    out = put(out, asteroids->seed, sizeof(Uint32) * asteroids->count);
+    out = put(out, asteroids->size, sizeof(AsteroidSize) * asteroids->count);
+    out = put(out, asteroids->shape,
+              sizeof(AsteroidShape) * asteroids->count);
+    return out;
+}
+
+static const Uint8* get_asteroids(const Uint8* in, AsteroidArray* asteroids) {
+    size_t floats = sizeof(float) * asteroids->count;
+    in = get(in, asteroids->x, floats);
+    in = get(in, asteroids->y, floats);
+    in = get(in, asteroids->vx, floats);
+    in = get(in, asteroids->vy, floats);
+    in = get(in, asteroids->px, floats);
+    in = get(in, asteroids->py, floats);
+    in = get(in, asteroids->seed, sizeof(Uint32) * asteroids->count);
+    in = get(in, asteroids->size, sizeof(AsteroidSize) * asteroids->count);
+    in = get(in, asteroids->shape, sizeof(AsteroidShape) * asteroids->count);
+    return in;
+}
+
+static Uint8* put_projectiles(Uint8* out,
+                              const ProjectileArray* projectiles) {
+    size_t floats = sizeof(float) * projectiles->count;
+    out = put(out, projectiles->x, floats);
+    out = put(out, projectiles->y, floats);
+    out = put(out, projectiles->vx, floats);
+    out = put(out, projectiles->vy, floats);
+    out = put(out, projectiles->px, floats);
+    out = put(out, projectiles->py, floats);
+    out = put(out, projectiles->spawnTime,
+              sizeof(Uint32) * projectiles->count);
+    return out;
+}
+
+static const Uint8* get_projectiles(const Uint8* in,
+                                    ProjectileArray* projectiles) {
+    size_t floats = sizeof(float) * projectiles->count;
+    in = get(in, projectiles->x, floats);
+    in = get(in, projectiles->y, floats);
+    in = get(in, projectiles->vx, floats);
+    in = get(in, projectiles->vy, floats);
+    in = get(in, projectiles->px, floats);
+    in = get(in, projectiles->py, floats);
+    in = get(in, projectiles->spawnTime, sizeof(Uint32) * projectiles->count);
+    return in;
+}
+
+// The ring is written oldest first, so loading puts it back from index 0
+static Uint8* put_ring(Uint8* out, const float* column,
+                       const ParticleSystem* particles) {
+    int first = particle_first_run(particles);
+    out = put(out, column + particles->tail, sizeof(float) * first);
+    return put(out, column, sizeof(float) * (particles->count - first));
+}
+
+static Uint8* put_particles(Uint8* out, const ParticleSystem* particles) {
+    out = put_ring(out, particles->x, particles);
+    out = put_ring(out, particles->y, particles);
+    out = put_ring(out, particles->px, particles);
+    out = put_ring(out, particles->py, particles);
+    out = put_ring(out, particles->vx, particles);
+    out = put_ring(out, particles->vy, particles);
+    out = put_ring(out, particles->ex, particles);
+    out = put_ring(out, particles->ey, particles);
+    out = put_ring(out, particles->life, particles);
+    return out;
+}
+
+static const Uint8* get_particles(const Uint8* in,
+                                  ParticleSystem* particles) {
+    size_t floats = sizeof(float) * particles->count;
+    in = get(in, particles->x, floats);
+    in = get(in, particles->y, floats);
+    in = get(in, particles->px, floats);
+    in = get(in, particles->py, floats);
+    in = get(in, particles->vx, floats);
+    in = get(in, particles->vy, floats);
+    in = get(in, particles->ex, floats);
+    in = get(in, particles->ey, floats);
+    in = get(in, particles->life, floats);
+    return in;
+}
+
+// Grids, the destroyed list and sounds are rebuilt or owned elsewhere, so
+// only the simulation itself is written
+int save_snapshot(const State* state, Uint64 tick, Snapshot* snapshot) {
+    size_t size = snapshot_size(state);
+    if (size > snapshot->capacity) {
+        Uint8* data = (Uint8*)realloc(snapshot->data, size);
+        if (!data) {
+            fprintf(stderr, "Failed to allocate snapshot!\n");
+            return 0;
+        }
+        snapshot->data = data;
+        snapshot->capacity = size;
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header)); // no stray bytes in the padding
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.size = size;
+    header.tick = tick;
+    header.pairTests = state->pairTests;
+    header.score = state->score;
+    header.level = state->level;
+    header.numAliens = state->aliens.count;
+    header.numAsteroids = state->asteroids.count;
+    header.numSpawns = state->spawns.count;
+    header.numProjectiles = state->projectiles.count;
+    header.numAlienProjs = state->alienProjs.count;
+    header.numParticles = state->particles.count;
+    header.rng = state->rng;
+    header.fxRng = state->fxRng;
+    header.player = *state->player;
+
+    Uint8* out = put(snapshot->data, &header, sizeof(header));
+    out = put_aliens(out, &state->aliens);
+    out = put_asteroids(out, &state->asteroids);
+    const SpawnQueue* spawns = &state->spawns;
+    out = put(out, spawns->count > 0 ? spawns->items + spawns->head : NULL,
+              sizeof(SpawnRequest) * spawns->count);
+    out = put_projectiles(out, &state->projectiles);
+    out = put_projectiles(out, &state->alienProjs);
+    put_particles(out, &state->particles);
+    snapshot->size = size;
+    return 1;
+}
+
+// Reuses the arrays already in state, only growing those that are too small
+int load_snapshot(State* state, const Snapshot* snapshot, Uint64* tick) {
+    SnapshotHeader header;
+    if (snapshot->size < sizeof(header)) {
+        fprintf(stderr, "Snapshot is truncated!\n");
+        return 0;
+    }
+    const Uint8* in = get(snapshot->data, &header, sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        header.version != SNAPSHOT_VERSION) {
+        fprintf(stderr, "Snapshot is not from this version!\n");
+        return 0;
+    }
+    // The counts decide how much is read, so they must match the buffer
+    if (header.numAliens < 0 || header.numAsteroids < 0 ||
+        header.numSpawns < 0 || header.numProjectiles < 0 ||
+        header.numAlienProjs < 0 || header.numParticles < 0 ||
+        header.size != snapshot->size ||
+        layout_size(header.numAliens, header.numAsteroids, header.numSpawns,
+                    header.numProjectiles, header.numAlienProjs,
+                    header.numParticles) != header.size) {
+        fprintf(stderr, "Snapshot is corrupt!\n");
+        return 0;
+    }
+
+    if (!resize_aliens(&state->aliens, header.numAliens) ||
+        !resize_asteroids(&state->asteroids, header.numAsteroids) ||
+        !resize_spawns(&state->spawns, header.numSpawns) ||
+        !resize_projectiles(&state->projectiles, header.numProjectiles) ||
+        !resize_projectiles(&state->alienProjs, header.numAlienProjs) ||
+        !resize_particles(&state->particles, header.numParticles)) {
+        fprintf(stderr, "Failed to allocate snapshot entities!\n");
+        return 0;
+    }
+
+    state->pairTests = header.pairTests;
+    state->score = header.score;
+    state->level = header.level;
+    state->rng = header.rng;
+    state->fxRng = header.fxRng;
+    *state->player = header.player;
+
+    in = get_aliens(in, &state->aliens);
+    in = get_asteroids(in, &state->asteroids);
+    in = get(in, state->spawns.items, sizeof(SpawnRequest) * header.numSpawns);
+    in = get_projectiles(in, &state->projectiles);
+    in = get_projectiles(in, &state->alienProjs);
+    get_particles(in, &state->particles);
+    if (tick) {
+        *tick = header.tick;
+    }
+    return 1;
+}
+
+/*------------------------------------VIEWS-----------------------------------*/
+
+// Positions at both ends of the tick for each entity, asteroid outlines,
+// and the particle columns drawn
+static size_t view_layout_size(int numAliens, int numAsteroids,
+                               int numProjectiles, int numAlienProjs,
+                               int numParticles) {
+    int numMoving = numAliens + numAsteroids + numProjectiles + numAlienProjs;
+    return sizeof(ViewHeader) + 4 * sizeof(float) * numMoving +
+           sizeof(AsteroidShape) * numAsteroids +
+           7 * sizeof(float) * numParticles;
+}
+
+static Uint8* put_positions(Uint8* out, const float* x, const float* y,
+                            const float* px, const float* py, int count) {
+    size_t floats = sizeof(float) * count;
+    out = put(out, x, floats);
+    out = put(out, y, floats);
+    out = put(out, px, floats);
+    return put(out, py, floats);
+}
+
+static const Uint8* get_positions(const Uint8* in, float* x, float* y,
+                                  float* px, float* py, int count) {
+    size_t floats = sizeof(float) * count;
+    in = get(in, x, floats);
+    in = get(in, y, floats);
+    in = get(in, px, floats);
+    return get(in, py, floats);
+}
+
+// A snapshot of only what is drawn, published every tick for the renderer.
+// It leaves out velocities, timers, handles, the spawn queue and the random
+// streams, so it cannot be loaded back into a running simulation.
+int save_view(const State* state, Uint64 tick, Snapshot* snapshot) {
+    const AlienArray* aliens = &state->aliens;
+    const AsteroidArray* asteroids = &state->asteroids;
+    const ProjectileArray* projectiles = &state->projectiles;
+    const ProjectileArray* alienProjs = &state->alienProjs;
+    const ParticleSystem* particles = &state->particles;
+    size_t size = view_layout_size(aliens->count, asteroids->count,
+                                   projectiles->count, alienProjs->count,
+                                   particles->count);
+    if (size > snapshot->capacity) {
+        Uint8* data = (Uint8*)realloc(snapshot->data, size);
+        if (!data) {
+            fprintf(stderr, "Failed to allocate view!\n");
+            return 0;
+        }
+        snapshot->data = data;
+        snapshot->capacity = size;
+    }
+
+    ViewHeader header;
+    memset(&header, 0, sizeof(header)); // no stray bytes in the padding
+    memcpy(header.magic, VIEW_MAGIC, sizeof(VIEW_MAGIC));
+    header.version = VIEW_VERSION;
+    header.size = size;
+    header.tick = tick;
+    header.pairTests = state->pairTests;
+    header.score = state->score;
+    header.level = state->level;
+    header.numAliens = aliens->count;
+    header.numAsteroids = asteroids->count;
+    header.numProjectiles = projectiles->count;
+    header.numAlienProjs = alienProjs->count;
+    header.numParticles = particles->count;
+    header.player = *state->player;
+
+    Uint8* out = put(snapshot->data, &header, sizeof(header));
+    out = put_positions(out, aliens->x, aliens->y, aliens->px, aliens->py,
+                        aliens->count);
+    out = put_positions(out, asteroids->x, asteroids->y, asteroids->px,
+                        asteroids->py, asteroids->count);
+    out = put(out, asteroids->shape,
+              sizeof(AsteroidShape) * asteroids->count);
+    out = put_positions(out, projectiles->x, projectiles->y, projectiles->px,
+                        projectiles->py, projectiles->count);
+    out = put_positions(out, alienProjs->x, alienProjs->y, alienProjs->px,
+                        alienProjs->py, alienProjs->count);
+    out = put_ring(out, particles->x, particles);
+    out = put_ring(out, particles->y, particles);
+    out = put_ring(out, particles->px, particles);
+    out = put_ring(out, particles->py, particles);
+    out = put_ring(out, particles->ex, particles);
+    out = put_ring(out, particles->ey, particles);
+    put_ring(out, particles->life, particles);
+    snapshot->size = size;
+    return 1;
+}
+
+// Loads a view into a state used only for drawing. The columns a view
+// leaves out keep whatever they held before.
+int load_view(State* state, const Snapshot* snapshot, Uint64* tick) {
+    ViewHeader header;
+    if (snapshot->size < sizeof(header)) {
+        fprintf(stderr, "View is truncated!\n");
+        return 0;
+    }
+    const Uint8* in = get(snapshot->data, &header, sizeof(header));
+    if (memcmp(header.magic, VIEW_MAGIC, sizeof(VIEW_MAGIC)) != 0 ||
+        header.version != VIEW_VERSION) {
+        fprintf(stderr, "View is not from this version!\n");
+        return 0;
+    }
+    if (header.numAliens < 0 || header.numAsteroids < 0 ||
+        header.numProjectiles < 0 || header.numAlienProjs < 0 ||
+        header.numParticles < 0 || header.size != snapshot->size ||
+        view_layout_size(header.numAliens, header.numAsteroids,
+                         header.numProjectiles, header.numAlienProjs,
+                         header.numParticles) != header.size) {
+        fprintf(stderr, "View is corrupt!\n");
+        return 0;
+    }
+
+    AlienArray* aliens = &state->aliens;
+    AsteroidArray* asteroids = &state->asteroids;
+    ProjectileArray* projectiles = &state->projectiles;
+    ProjectileArray* alienProjs = &state->alienProjs;
+    ParticleSystem* particles = &state->particles;
+    if (!resize_aliens(aliens, header.numAliens) ||
+        !resize_asteroids(asteroids, header.numAsteroids) ||
+        !resize_projectiles(projectiles, header.numProjectiles) ||
+        !resize_projectiles(alienProjs, header.numAlienProjs) ||
+        !resize_particles(particles, header.numParticles)) {
+        fprintf(stderr, "Failed to allocate view entities!\n");
+        return 0;
+    }
+
+    state->pairTests = header.pairTests;
+    state->score = header.score;
+    state->level = header.level;
+    *state->player = header.player;
+
+    in = get_positions(in, aliens->x, aliens->y, aliens->px, aliens->py,
+                       aliens->count);
+    in = get_positions(in, asteroids->x, asteroids->y, asteroids->px,
+                       asteroids->py, asteroids->count);
+    in = get(in, asteroids->shape, sizeof(AsteroidShape) * asteroids->count);
+    in = get_positions(in, projectiles->x, projectiles->y, projectiles->px,
+                       projectiles->py, projectiles->count);
+    in = get_positions(in, alienProjs->x, alienProjs->y, alienProjs->px,
+                       alienProjs->py, alienProjs->count);
+    size_t floats = sizeof(float) * particles->count;
+    in = get(in, particles->x, floats);
+    in = get(in, particles->y, floats);
+    in = get(in, particles->px, floats);
+    in = get(in, particles->py, floats);
+    in = get(in, particles->ex, floats);
+    in = get(in, particles->ey, floats);
+    get(in, particles->life, floats);
+    if (tick) {
+        *tick = header.tick;
+    }
+    return 1;
+}
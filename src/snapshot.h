@@ -0,0 +1,26 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "game.h"
+#include <stddef.h>
+
+// A snapshot is one contiguous buffer: a fixed header holding every scalar
+// part of State, then each entity column back to back. Nothing in it is a
+// pointer, so it can be copied, hashed or written out as is. The layout is
+// that of the running build, it is not a portable save format. A view is
+// a smaller snapshot holding only what is drawn, laid out the same way.
+typedef struct {
+    Uint8* data;
+    size_t size;
+    size_t capacity; // kept between saves so steady state never allocates
+} Snapshot;
+
+void init_snapshot(Snapshot* snapshot);
+void free_snapshot(Snapshot* snapshot);
+size_t snapshot_size(const State* state);
+int save_snapshot(const State* state, Uint64 tick, Snapshot* snapshot);
+int load_snapshot(State* state, const Snapshot* snapshot, Uint64* tick);
+int save_view(const State* state, Uint64 tick, Snapshot* snapshot);
+int load_view(State* state, const Snapshot* snapshot, Uint64* tick);
+
+#endif
@@ -0,0 +1,166 @@
+#include "sound.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+// A full budget gives up the lowest priority voice for a higher one
+const int SOUND_PRIORITIES[NUM_SOUNDS] = {
+    4, // explosion
+    0, // shoot
+    1, // hit
+    2, // alien
+    3, // ran
+};
+
+// Minimum time between two plays of a sound, in milliseconds. Triggers in
+// between are dropped, so a burst of hits is heard once, not stacked.
+const Uint32 SOUND_SPACING[NUM_SOUNDS] = {
+    250, // explosion
+    0,   // shoot, already limited by the fire rate
+    50,  // hit
+    100, // alien
+    250, // ran
+};
+
+// Highest priority first
+const SoundId SOUND_ORDER[NUM_SOUNDS] = {
+    SOUND_EXPLOSION, SOUND_RAN, SOUND_ALIEN, SOUND_HIT, SOUND_SHOOT,
+};
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+// Called from the simulation, one atomic add and no mixer lock
+void queue_sound(SoundManager* sounds, SoundId id) {
+    if (sounds) {
+        SDL_AtomicAdd(&sounds->pending[id], 1);
+    }
+}
+
+// A free channel, else the lowest priority one if id outranks it, else -1
+static int claim_voice(SoundManager* sounds, SoundId id) {
+    int lowest = -1;
+    for (int i = 0; i < SOUND_VOICES; i++) {
+        if (sounds->voices[i] < 0 || !Mix_Playing(i)) {
+            return i;
+        }
+        if (lowest < 0 || SOUND_PRIORITIES[sounds->voices[i]] <
+                              SOUND_PRIORITIES[sounds->voices[lowest]]) {
+            lowest = i;
+        }
+    }
+    if (SOUND_PRIORITIES[sounds->voices[lowest]] >= SOUND_PRIORITIES[id]) {
+        return -1;
+    }
+    Mix_HaltChannel(lowest);
+    return lowest;
+}
+
+// Once per frame on the main thread, which owns the mixer. Sounds are
+// taken in priority order so the budget goes to the most important first.
+void flush_sounds(SoundManager* sounds, Uint32 time) {
+    if (!sounds) {
+        return;
+    }
+
+    for (int i = 0; i < NUM_SOUNDS; i++) {
+        SoundId id = SOUND_ORDER[i];
+        int count = SDL_AtomicSet(&sounds->pending[id], 0);
+        if (count == 0 || time < sounds->nextPlay[id]) {
+            continue;
+        }
+
+        int channel = claim_voice(sounds, id);
+        if (channel >= 0 &&
+            Mix_PlayChannel(channel, sounds->chunks[id], 0) >= 0) {
+            sounds->voices[channel] = id;
+            sounds->nextPlay[id] = time + SOUND_SPACING[id];
+        }
+    }
+}
+
+// Points the chunk straight at the pack when the mixer was opened in its
+// format, otherwise converts one copy into sounds->converted
+static Mix_Chunk* load_asset(SoundManager* sounds, int id, const Uint8* pcm,
+                             Uint32 length) {
+    int frequency = 0;
+    Uint16 format = 0;
+    int channels = 0;
+    Mix_QuerySpec(&frequency, &format, &channels);
+
+    SDL_AudioCVT cvt;
+    int needed = SDL_BuildAudioCVT(&cvt, ASSET_FORMAT, ASSET_CHANNELS,
+                                   ASSET_FREQUENCY, format, channels,
+                                   frequency);
+    if (needed < 0) {
+        return NULL;
+    }
+    if (needed == 0) {
+        return Mix_QuickLoad_RAW((Uint8*)pcm, length); // only ever read
+    }
+
+    cvt.len = length;
+    cvt.buf = (Uint8*)malloc(length * cvt.len_mult);
+    if (!cvt.buf) {
+        return NULL;
+    }
+    memcpy(cvt.buf, pcm, length);
+    if (SDL_ConvertAudio(&cvt) < 0) {
+        free(cvt.buf);
+        return NULL;
+    }
+    sounds->converted[id] = cvt.buf;
+    return Mix_QuickLoad_RAW(cvt.buf, cvt.len_cvt);
+}
+
+// Takes the sounds in SoundId order from a pack written by pack_assets,
+// after the mixer is open. Nothing is read from disk.
+SoundManager* init_soundmanager(const Uint8* data, const AssetEntry* assets,
+                                int numAssets) {
+    if (!data || !assets || numAssets < NUM_SOUNDS) {
+        fprintf(stderr, "Asset pack is missing sounds!\n");
+        return NULL;
+    }
+
+    SoundManager* sounds = (SoundManager*)calloc(1, sizeof(SoundManager));
+    if (!sounds) {
+        fprintf(stderr, "Failed to allocate sound manager!\n");
+        return NULL;
+    }
+
+    for (int i = 0; i < NUM_SOUNDS; i++) {
+        sounds->chunks[i] = load_asset(sounds, i, data + assets[i].offset,
+                                       assets[i].length);
+        if (!sounds->chunks[i]) {
+            fprintf(stderr, "Failed to load sound effects!\n");
+            free_soundmanager(sounds);
+            return NULL;
+        }
+    }
+
+    for (int i = 0; i < SOUND_VOICES; i++) {
+        sounds->voices[i] = -1;
+    }
+
+    // Set the volume to quarter of maximum
+    Mix_AllocateChannels(SOUND_VOICES);
+    Mix_Volume(-1, MIX_MAX_VOLUME / 4);
+
+    return sounds;
+}
+
+void free_soundmanager(SoundManager* sounds) {
+    if (!sounds) {
+        return;
+    }
+
+    for (int i = 0; i < NUM_SOUNDS; i++) {
+        if (sounds->chunks[i]) {
+            Mix_FreeChunk(sounds->chunks[i]);
+        }
+        free(sounds->converted[i]);
+    }
+
+    free(sounds);
+}
@@ -0,0 +1,36 @@
+#ifndef SOUND_H
+#define SOUND_H
+
+#include "assets.h"
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_mixer.h>
+
+#define SOUND_VOICES 8 // mixer channels, the most sounds playing at once
+
+typedef enum {
+    SOUND_EXPLOSION,
+    SOUND_SHOOT,
+    SOUND_HIT,
+    SOUND_ALIEN,
+    SOUND_RAN,
+    NUM_SOUNDS,
+} SoundId;
+
+// The simulation only counts triggers per sound, and the main thread
+// turns them into at most one play per sound per frame in flush_sounds()
+typedef struct {
+    Mix_Chunk* chunks[NUM_SOUNDS];
+    Uint8* converted[NUM_SOUNDS]; // owned PCM if the mixer format differs
+    SDL_atomic_t pending[NUM_SOUNDS]; // triggers since the last flush
+    Uint32 nextPlay[NUM_SOUNDS];      // earliest time each may play again
+    int voices[SOUND_VOICES];         // SoundId on each channel, or -1
+} SoundManager;
+
+SoundManager* init_soundmanager(const Uint8* data, const AssetEntry* assets,
+                                int numAssets);
+void free_soundmanager(SoundManager* sounds);
+// Safe to call without a sound manager (headless runs have no mixer)
+void queue_sound(SoundManager* sounds, SoundId id);
+void flush_sounds(SoundManager* sounds, Uint32 time);
+
+#endif
@@ -36,19 +36,29 @@ inline Vector2 vector_aro(const Vector2 vec, const Vector2 center, float angle)
     return create_vector(rotatedX + center.x, rotatedY + center.y);
 }
 
-void draw_line(SDL_Renderer* renderer, Vector2 start, Vector2 end) {
-    SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
-    SDL_RenderDrawLine(renderer, start.x, start.y, end.x, end.y);
+// Equivalent to vector_aro() about position for a point given relative
+// to it
+Transform create_transform(Vector2 position, float angle) {
+    Transform transform;
+    transform.cosTheta = cos(angle);
+    transform.sinTheta = sin(angle);
+    transform.translation = position;
+    return transform;
 }
 
-void draw_shape(SDL_Renderer* renderer, const Vector2 points[], int size) {
-    for (int i = 0; i < size - 1; i++) {
-        draw_line(renderer, points[i], points[i + 1]);
+// Places one shape per transform, numPoints apart in out. The inner loop
+// has no calls or branches so the compiler can vectorize it.
+void transform_shape(const Transform* transforms, int numTransforms,
+                     const Vector2* shape, int numPoints, Vector2* out) {
+    for (int t = 0; t < numTransforms; t++) {
+        float c = transforms[t].cosTheta;
+        float s = transforms[t].sinTheta;
+        float x = transforms[t].translation.x;
+        float y = transforms[t].translation.y;
+        Vector2* points = out + t * numPoints;
+        for (int i = 0; i < numPoints; i++) {
+            points[i].x = shape[i].x * c - shape[i].y * s + x;
+            points[i].y = shape[i].x * s + shape[i].y * c + y;
+        }
     }
-    draw_line(renderer, points[0], points[size - 1]);
-}
-
-void draw_thick_point(SDL_Renderer* renderer, int x, int y, int thickness) {
-    SDL_Rect rect = { x - thickness / 2, y - thickness / 2, thickness, thickness };
-    SDL_RenderFillRect(renderer, &rect);
 }
@@ -1,4 +1,5 @@
-#ifndef  VEC_H
+#ifndef VEC_H
+#define VEC_H
 
 #include <SDL2/SDL.h>
 
@@ -8,14 +9,21 @@ typedef struct {
     float y;
 } Vector2;
 
+// Rotation then translation of one entity, with the trig done once
+typedef struct {
+    float cosTheta;
+    float sinTheta;
+    Vector2 translation;
+} Transform;
+
 Vector2 create_vector(float x, float y);
 Vector2 vector_sum(const Vector2 a, const Vector2 b);
 Vector2 vector_mul(const Vector2 vec, float factor);
 Vector2 vector_rot(const Vector2 vec, float angle);
 Vector2 vector_aro(const Vector2 vec, const Vector2 center, float angle);
-void draw_line(SDL_Renderer* renderer, const Vector2 a, const Vector2 b);
-void draw_shape(SDL_Renderer* renderer, const Vector2 points[], int size);
-void draw_thick_point(SDL_Renderer* renderer, int x, int y, int thickness);
+Transform create_transform(Vector2 position, float angle);
+void transform_shape(const Transform* transforms, int numTransforms,
+                     const Vector2* shape, int numPoints, Vector2* out);
 
 
 #endif
@@ -0,0 +1,144 @@
+#include "game.h"
+#include <stdio.h>
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+const Vector2 TARGET = {500, 400};
+
+/*-----------------------------------HELPERS----------------------------------*/
+
+static int failures = 0;
+
+static void check(int passed, const char* name) {
+    printf("%s: %s\n", passed ? "ok" : "FAILED", name);
+    if (!passed) {
+        failures++;
+    }
+}
+
+// A state holding nothing but what the case adds
+static State* empty_state(void) {
+    State* state = init_state();
+    if (!state) {
+        return NULL;
+    }
+    seed_state(state, 1);
+    return state;
+}
+
+// A shot that has not moved this tick, so the sweep is a point test
+static void place_shot(ProjectileArray* shots, float x, float y) {
+    push_projectile(shots, create_vector(x, y), create_vector(0, 0), 0);
+}
+
+// A shot that moved from start to end this tick
+static void move_shot(ProjectileArray* shots, Vector2 start, Vector2 end) {
+    int idx = push_projectile(shots, end, create_vector(0, 0), 0);
+    if (idx >= 0) {
+        shots->px[idx] = start.x;
+        shots->py[idx] = start.y;
+    }
+}
+
+/*------------------------------------CASES-----------------------------------*/
+
+// Shots do not wrap, one a screen away is nowhere near the target even
+// though the grid folds its coordinates onto the same cell
+static void shot_off_screen(float offsetX, float offsetY, const char* name) {
+    State* state = empty_state();
+    if (!state) {
+        check(0, name);
+        return;
+    }
+    add_asteroid(state, LARGE, TARGET, 1);
+    push_alien(&state->aliens, create_vector(TARGET.x, TARGET.y + 200), 0);
+    place_shot(&state->projectiles, TARGET.x + offsetX, TARGET.y + offsetY);
+    place_shot(&state->projectiles, TARGET.x + offsetX,
+               TARGET.y + 200 + offsetY);
+    detect_Shoot(state);
+    check(state->asteroids.count == 1 && state->aliens.count == 1 &&
+              state->projectiles.count == 2 && state->score == 0,
+          name);
+    free_state(state);
+}
+
+static void alien_shot_off_screen(void) {
+    State* state = empty_state();
+    if (!state) {
+        check(0, "alien shot a screen away misses the ship");
+        return;
+    }
+    Vector2 position = state->player->position;
+    place_shot(&state->alienProjs, position.x + SCREEN_WIDTH, position.y);
+    detect_crash(state, 0);
+    check(!state->player->crashed, "alien shot a screen away misses the ship");
+    free_state(state);
+}
+
+// The same shots on the screen do hit, so the cases above test the offset
+static void shot_on_target(void) {
+    State* state = empty_state();
+    if (!state) {
+        check(0, "shot on the target hits");
+        return;
+    }
+    add_asteroid(state, LARGE, TARGET, 1);
+    push_alien(&state->aliens, create_vector(TARGET.x, TARGET.y + 200), 0);
+    place_shot(&state->projectiles, TARGET.x, TARGET.y);
+    place_shot(&state->projectiles, TARGET.x, TARGET.y + 200);
+    detect_Shoot(state);
+    check(state->asteroids.count == 0 && state->aliens.count == 0 &&
+              state->projectiles.count == 0 && state->score > 0,
+          "shot on the target hits");
+    free_state(state);
+}
+
+// A single moving shot against a lone asteroid, checks whether it hit
+static void sweep_case(AsteroidSize size, Vector2 start, Vector2 end,
+                       int shouldHit, const char* name) {
+    State* state = empty_state();
+    if (!state) {
+        check(0, name);
+        return;
+    }
+    add_asteroid(state, size, TARGET, 1);
+    move_shot(&state->projectiles, start, end);
+    detect_Shoot(state);
+    int hit = state->asteroids.count == 0 && state->projectiles.count == 0;
+    check(hit == shouldHit, name);
+    free_state(state);
+}
+
+static void moving_shots(void) {
+    // Both ends lie outside the asteroid, only the path between crosses it
+    float reach = 5 * SMALL * MAX_RADIUS;
+    sweep_case(SMALL, create_vector(TARGET.x - reach, TARGET.y),
+               create_vector(TARGET.x + reach, TARGET.y), 1,
+               "shot stepping over a small asteroid hits");
+
+    // Passes at twice the largest radius the outline can reach
+    float gap = 2 * SMALL * MAX_RADIUS;
+    sweep_case(SMALL, create_vector(0, TARGET.y - gap),
+               create_vector(SCREEN_WIDTH - 1, TARGET.y - gap), 0,
+               "long step passing near an asteroid misses");
+
+    // More than half the screen in one tick, as at a very low tick rate
+    sweep_case(SMALL, create_vector(10, TARGET.y),
+               create_vector(SCREEN_WIDTH - 10, TARGET.y), 1,
+               "step across most of the screen hits");
+    sweep_case(SMALL, create_vector(TARGET.x, SCREEN_HEIGHT - 10),
+               create_vector(TARGET.x, 10), 1,
+               "step up most of the screen hits");
+}
+
+/*------------------------------------MAIN------------------------------------*/
+
+int main(void) {
+    shot_on_target();
+    shot_off_screen(SCREEN_WIDTH, 0, "shot a screen right misses");
+    shot_off_screen(-SCREEN_WIDTH, 0, "shot a screen left misses");
+    shot_off_screen(0, SCREEN_HEIGHT, "shot a screen down misses");
+    alien_shot_off_screen();
+    moving_shots();
+    return failures > 0;
+}
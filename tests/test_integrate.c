@@ -0,0 +1,99 @@
+#include "integrate.h"
+#include <stdio.h>
+#include <string.h>
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+// Not a multiple of eight or four, so every backend also runs its tail
+#define NUM_VALUES 45
+
+const float WIDTH = 1000.0f;
+const float HEIGHT = 800.0f;
+const float DELTA = 1.0f / 60.0f;
+
+// Starting coordinates on the screen, just off it, a screen or more off
+// it and far away, with velocities that move some of them across an edge
+const float STARTS[] = {
+    0.0f, 1.0f, -0.0f, 999.99f, 1000.0f, 1000.5f, -0.001f, -1.0f, -999.0f,
+    -1000.0f, -1500.0f, 1999.0f, 2000.0f, 2500.0f, -2000.0f, -2001.0f, 5000.0f,
+    -7777.7f, 1.0e6f, -1.0e6f, 400.0f, 799.99f, 800.0f, -800.0f, 1600.0f,
+};
+const float VELOCITIES[] = {
+    0.0f, 60.0f, -60.0f, 600.0f, -600.0f, 1.0e4f, -1.0e4f, 6.0e4f, -6.0e4f,
+    1.0e5f, 3.0f, -3.0f, 1.0e7f, -1.0e7f, 123.4f,
+};
+
+/*-----------------------------------HELPERS----------------------------------*/
+
+static int failures = 0;
+
+static void check(int passed, const char* name, const char* backend) {
+    printf("%s: %s (%s)\n", passed ? "ok" : "FAILED", name, backend);
+    if (!passed) {
+        failures++;
+    }
+}
+
+static void fill(float* x, float* y, float* vx, float* vy) {
+    int numStarts = sizeof(STARTS) / sizeof(STARTS[0]);
+    int numVelocities = sizeof(VELOCITIES) / sizeof(VELOCITIES[0]);
+    for (int i = 0; i < NUM_VALUES; i++) {
+        x[i] = STARTS[i % numStarts];
+        y[i] = STARTS[(i * 7 + 3) % numStarts];
+        vx[i] = VELOCITIES[i % numVelocities];
+        vy[i] = VELOCITIES[(i * 5 + 2) % numVelocities];
+    }
+}
+
+static int in_range(const float* values, float size) {
+    for (int i = 0; i < NUM_VALUES; i++) {
+        if (!(values[i] >= 0 && values[i] < size)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*------------------------------------CASES-----------------------------------*/
+
+// Every backend must match the scalar kernels bit for bit, see integrate.h
+static void compare_backend(IntegrateBackend backend) {
+    const char* name = integrate_backend_name(backend);
+    float x[NUM_VALUES], y[NUM_VALUES], vx[NUM_VALUES], vy[NUM_VALUES];
+    float sx[NUM_VALUES], sy[NUM_VALUES];
+
+    set_integrate_backend(INTEGRATE_SCALAR);
+    fill(sx, sy, vx, vy);
+    integrate(sx, sy, vx, vy, NUM_VALUES, DELTA);
+    set_integrate_backend(backend);
+    fill(x, y, vx, vy);
+    integrate(x, y, vx, vy, NUM_VALUES, DELTA);
+    check(memcmp(x, sx, sizeof(x)) == 0 && memcmp(y, sy, sizeof(y)) == 0,
+          "integrate matches scalar", name);
+
+    set_integrate_backend(INTEGRATE_SCALAR);
+    fill(sx, sy, vx, vy);
+    integrate_wrap(sx, sy, vx, vy, NUM_VALUES, DELTA, WIDTH, HEIGHT);
+    set_integrate_backend(backend);
+    fill(x, y, vx, vy);
+    integrate_wrap(x, y, vx, vy, NUM_VALUES, DELTA, WIDTH, HEIGHT);
+    check(memcmp(x, sx, sizeof(x)) == 0 && memcmp(y, sy, sizeof(y)) == 0,
+          "integrate_wrap matches scalar", name);
+    check(in_range(x, WIDTH) && in_range(y, HEIGHT),
+          "integrate_wrap lands on the screen", name);
+}
+
+/*------------------------------------MAIN------------------------------------*/
+
+int main(void) {
+    for (int i = 0; i < NUM_INTEGRATE_BACKENDS; i++) {
+        IntegrateBackend backend = (IntegrateBackend)i;
+        if (!set_integrate_backend(backend)) {
+            printf("skipped: %s not supported\n",
+                   integrate_backend_name(backend));
+            continue;
+        }
+        compare_backend(backend);
+    }
+    return failures > 0;
+}
@@ -0,0 +1,130 @@
+#include "assets.h"
+#include <SDL2/SDL_audio.h>
+#include <SDL2/SDL_rwops.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Build step for the game: decodes each WAV, converts it to the mixer's
+// output format and writes them all as one C array to link into the
+// binary. Usage: pack_assets OUTPUT.c SOUND.wav...
+
+/*----------------------------------CONSTANTS---------------------------------*/
+
+const int BYTES_PER_LINE = 16;
+
+/*-----------------------------------STRUCTS----------------------------------*/
+
+typedef struct {
+    Uint8* pcm;
+    Uint32 length;
+} PackedSound;
+
+/*----------------------------------FUNCTIONS---------------------------------*/
+
+static int convert_wav(const char* path, PackedSound* sound) {
+    SDL_AudioSpec spec;
+    Uint8* wav;
+    Uint32 wavLength;
+    if (!SDL_LoadWAV(path, &spec, &wav, &wavLength)) {
+        fprintf(stderr, "Failed to load %s!\n", path);
+        return 0;
+    }
+
+    SDL_AudioCVT cvt;
+    int needed = SDL_BuildAudioCVT(&cvt, spec.format, spec.channels,
+                                   spec.freq, ASSET_FORMAT, ASSET_CHANNELS,
+                                   ASSET_FREQUENCY);
+    cvt.len = wavLength;
+    cvt.buf = needed >= 0 ? (Uint8*)malloc(wavLength * cvt.len_mult) : NULL;
+    if (!cvt.buf) {
+        fprintf(stderr, "Failed to convert %s!\n", path);
+        SDL_FreeWAV(wav);
+        return 0;
+    }
+    memcpy(cvt.buf, wav, wavLength);
+    SDL_FreeWAV(wav);
+
+    cvt.len_cvt = cvt.len;
+    if (needed && SDL_ConvertAudio(&cvt) < 0) {
+        fprintf(stderr, "Failed to convert %s!\n", path);
+        free(cvt.buf);
+        return 0;
+    }
+    sound->pcm = cvt.buf;
+    sound->length = (Uint32)cvt.len_cvt;
+    return 1;
+}
+
+static Uint32 align_offset(Uint32 offset) {
+    return (offset + ASSET_ALIGN - 1) / ASSET_ALIGN * ASSET_ALIGN;
+}
+
+static void write_pack(FILE* out, const PackedSound* sounds, int count) {
+    fprintf(out, "// Generated by pack_assets, do not edit\n");
+    fprintf(out, "#include \"assets.h\"\n\n");
+    fprintf(out, "const int NUM_ASSETS = %d;\n\n", count);
+
+    fprintf(out, "const AssetEntry ASSETS[] = {\n");
+    Uint32 offset = 0;
+    for (int i = 0; i < count; i++) {
+        fprintf(out, "    {%u, %u},\n", offset, sounds[i].length);
+        offset = align_offset(offset + sounds[i].length);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "_Alignas(ASSET_ALIGN) const Uint8 ASSET_DATA[] = {");
+    Uint32 written = 0;
+    for (int i = 0; i < count; i++) {
+        Uint32 end = align_offset(written + sounds[i].length);
+        for (Uint32 j = 0; written < end; j++, written++) {
+            if (written % BYTES_PER_LINE == 0) {
+                fprintf(out, "\n   ");
+            }
+            Uint8 byte = j < sounds[i].length ? sounds[i].pcm[j] : 0;
+            fprintf(out, " 0x%02x,", byte);
+        }
+    }
+    fprintf(out, "\n};\n");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s OUTPUT.c SOUND.wav...\n", argv[0]);
+        return 1;
+    }
+
+    int count = argc - 2;
+    PackedSound* sounds = (PackedSound*)calloc(count, sizeof(PackedSound));
+    if (!sounds) {
+        fprintf(stderr, "Failed to allocate asset pack!\n");
+        return 1;
+    }
+
+    int status = 0;
+    for (int i = 0; i < count && status == 0; i++) {
+        if (!convert_wav(argv[i + 2], &sounds[i])) {
+            status = 1;
+        }
+    }
+
+    FILE* out = status == 0 ? fopen(argv[1], "w") : NULL;
+    if (status == 0 && !out) {
+        fprintf(stderr, "Failed to open %s!\n", argv[1]);
+        status = 1;
+    }
+    if (out) {
+        write_pack(out, sounds, count);
+        if (fclose(out) != 0) {
+            fprintf(stderr, "Failed to write %s!\n", argv[1]);
+            remove(argv[1]); // a partial pack would still compile
+            status = 1;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        free(sounds[i].pcm);
+    }
+    free(sounds);
+    return status;
+}